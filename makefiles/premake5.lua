@@ -93,3 +93,28 @@ project('test')
 		optimize('On')
 
 	filter{}
+
+project('bench')
+	kind('ConsoleApp')
+	language('C++')
+	cppdialect('C++20')
+
+	includedirs {
+		src_dir
+	}
+
+	files {
+		src_dir .. 'bench/**.cpp',
+		src_dir .. 'bench/**.hpp'
+	}
+
+	filter('configurations:debug')
+		defines {'_DEBUG'}
+		symbols('On')
+
+	filter('configurations:release')
+		defines{'NDEBUG'}
+		symbols('On')
+		optimize('On')
+
+	filter{}
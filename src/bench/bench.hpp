@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace bench
+{
+
+/// <summary>
+/// Keep the compiler from optimizing away a value the benchmark computed
+/// </summary>
+template<class T>
+inline void do_not_optimize(T const& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	// a register alternative makes the compiler copy large values to the stack, containers are passed in memory
+	if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void*))
+		asm volatile("" : : "r,m"(value) : "memory");
+	else
+		asm volatile("" : : "m"(value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
+struct result
+{
+	std::string container;
+	std::string operation;
+	uint32_t element_size = 0;
+	uint32_t capacity = 0;
+	double ns_per_op = 0;
+	double ns_per_element = 0;
+	uint32_t samples = 0;
+};
+
+struct options
+{
+	uint32_t samples = 15;
+	std::chrono::nanoseconds min_sample_time = std::chrono::milliseconds(2);
+};
+
+/// <summary>
+/// Measure op on a batch of independent inputs: setup prepares all of them and is not timed, then op(0) ... op(batch - 1)
+/// run between one pair of clock reads and the time is divided by batch, so the cost of reading the clock doesn't swamp short ops.
+/// Each sample repeats batches until they ran for at least min_sample_time, the median of the samples is reported
+/// </summary>
+template<class setup_fn, class op_fn>
+inline double measure_ns(const options& opts, uint32_t batch, setup_fn&& setup, op_fn&& op)
+{
+	using clock = std::chrono::steady_clock;
+
+	std::vector<double> samples;
+	samples.reserve(opts.samples);
+
+	for (uint32_t s = 0; s < opts.samples; ++s)
+	{
+		clock::duration timed = {};
+		uint64_t reps = 0;
+
+		while (timed < opts.min_sample_time)
+		{
+			setup();
+
+			const clock::time_point start = clock::now();
+			for (uint32_t i = 0; i < batch; ++i)
+				op(i);
+			timed += clock::now() - start;
+
+			reps += batch;
+		}
+
+		samples.push_back(std::chrono::duration<double, std::nano>(timed).count() / double(reps));
+	}
+
+	std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+	return samples[samples.size() / 2];
+}
+
+/// <summary>
+/// Write results as JSON
+/// </summary>
+inline void write_json(std::ostream& out, const std::vector<result>& results)
+{
+	out << "{\n\t\"benchmarks\": [\n";
+
+	for (std::size_t i = 0; i < results.size(); ++i)
+	{
+		const result& r = results[i];
+
+		out << "\t\t{ "
+			<< "\"container\": \"" << r.container << "\", "
+			<< "\"operation\": \"" << r.operation << "\", "
+			<< "\"element_size\": " << r.element_size << ", "
+			<< "\"capacity\": " << r.capacity << ", "
+			<< "\"ns_per_op\": " << r.ns_per_op << ", "
+			<< "\"ns_per_element\": " << r.ns_per_element << ", "
+			<< "\"samples\": " << r.samples
+			<< " }" << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+
+	out << "\t]\n}\n";
+}
+
+}
@@ -0,0 +1,301 @@
+﻿#include "bench.hpp"
+
+#include <fv/fixed_vector.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace
+{
+
+template<uint32_t N>
+struct payload
+{
+	uint32_t key;
+	std::byte bytes[N - sizeof(uint32_t)];
+
+	payload() = default;
+	explicit payload(uint32_t k) : key(k) {}
+};
+
+// smallest item is the key alone, without a zero-size padding array
+template<>
+struct payload<sizeof(uint32_t)>
+{
+	uint32_t key;
+
+	payload() = default;
+	explicit payload(uint32_t k) : key(k) {}
+};
+
+// Every container is driven through the same set of operations:
+// make() returns a heap-held empty container, so large inline containers do not blow the stack
+
+template<class T, uint32_t capacity>
+struct fixed_vector_ops
+{
+	using container = fixed_vector<T>;
+	static constexpr const char* name = "fixed_vector";
+
+	static std::unique_ptr<container> make() { return std::make_unique<container>(capacity); }
+	static void push_back(container& c, const T& item) { c.push_back(item); }
+	static void emplace_back(container& c, uint32_t key) { c.emplace_back(key); }
+	static void remove(container& c, uint32_t index) { c.remove(index); }
+	static void clean(container& c) { c.clean(); }
+};
+
+template<class T, uint32_t capacity>
+struct std_vector_ops
+{
+	using container = std::vector<T>;
+	static constexpr const char* name = "std::vector+reserve";
+
+	static std::unique_ptr<container> make()
+	{
+		auto c = std::make_unique<container>();
+		c->reserve(capacity);
+		return c;
+	}
+	static void push_back(container& c, const T& item) { c.push_back(item); }
+	static void emplace_back(container& c, uint32_t key) { c.emplace_back(key); }
+	static void remove(container& c, uint32_t index)
+	{
+		if (index != c.size() - 1)
+			std::swap(c[index], c.back());
+		c.pop_back();
+	}
+	static void clean(container& c) { c.clear(); }
+};
+
+// std::array with a size counter: items are assigned, never constructed or destroyed
+template<class T, uint32_t capacity>
+struct std_array_ops
+{
+	struct container
+	{
+		std::array<T, capacity> items;
+		uint32_t count = 0;
+
+		T* begin() { return items.data(); }
+		T* end() { return items.data() + count; }
+	};
+	static constexpr const char* name = "std::array";
+
+	static std::unique_ptr<container> make() { return std::make_unique<container>(); }
+	static void push_back(container& c, const T& item) { c.items[c.count++] = item; }
+	static void emplace_back(container& c, uint32_t key) { c.items[c.count++] = T(key); }
+	static void remove(container& c, uint32_t index)
+	{
+		if (index != c.count - 1)
+			std::swap(c.items[index], c.items[c.count - 1]);
+		--c.count;
+	}
+	static void clean(container& c) { c.count = 0; }
+};
+
+// static_vector-style baseline: in-object storage, compile-time capacity
+template<class T, uint32_t capacity>
+struct inline_fixed_vector_ops
+{
+	using container = inline_fixed_vector<T, capacity>;
+	static constexpr const char* name = "inline_fixed_vector";
+
+	static std::unique_ptr<container> make() { return std::make_unique<container>(); }
+	static void push_back(container& c, const T& item) { c.push_back(item); }
+	static void emplace_back(container& c, uint32_t key) { c.emplace_back(key); }
+	static void remove(container& c, uint32_t index) { c.remove(index); }
+	static void clean(container& c) { c.clean(); }
+};
+
+// Small containers are timed in batches of independent ones, so one timed batch is long enough for the clock.
+// A batch holds up to 1 MiB of items, large containers run one at a time
+template<class T, uint32_t capacity>
+constexpr uint32_t batch_size = uint32_t(std::clamp<std::size_t>((std::size_t(1) << 20) / (std::size_t(capacity) * sizeof(T)), 1, 64));
+
+template<class ops, class T, uint32_t capacity>
+void run_container(const bench::options& opts, std::vector<bench::result>& results)
+{
+	using container = typename ops::container;
+	constexpr uint32_t batch = batch_size<T, capacity>;
+
+	auto add = [&](const char* operation, double ns) {
+		results.push_back(bench::result{ ops::name, operation, uint32_t(sizeof(T)), capacity, ns, ns / capacity, opts.samples });
+	};
+
+	const T item(7);
+
+	auto fill = [&](container& c) {
+		for (uint32_t i = 0; i < capacity; ++i)
+			ops::push_back(c, item);
+	};
+
+	std::vector<std::unique_ptr<container>> containers;
+	for (uint32_t i = 0; i < batch; ++i)
+		containers.push_back(ops::make());
+
+	auto clean_all = [&] {
+		for (auto& c : containers)
+			ops::clean(*c);
+	};
+
+	auto refill_all = [&] {
+		for (auto& c : containers)
+		{
+			ops::clean(*c);
+			fill(*c);
+		}
+	};
+
+	add("push_back", bench::measure_ns(opts, batch, clean_all, [&](uint32_t b) {
+		container& c = *containers[b];
+		for (uint32_t i = 0; i < capacity; ++i)
+			ops::push_back(c, item);
+		bench::do_not_optimize(c);
+	}));
+
+	add("emplace_back", bench::measure_ns(opts, batch, clean_all, [&](uint32_t b) {
+		container& c = *containers[b];
+		for (uint32_t i = 0; i < capacity; ++i)
+			ops::emplace_back(c, i);
+		bench::do_not_optimize(c);
+	}));
+
+	add("remove", bench::measure_ns(opts, batch, refill_all, [&](uint32_t b) {
+		container& c = *containers[b];
+		// always remove the first item, every call swaps with the last one
+		for (uint32_t i = 0; i < capacity; ++i)
+			ops::remove(c, 0);
+		bench::do_not_optimize(c);
+	}));
+
+	add("clean", bench::measure_ns(opts, batch, refill_all, [&](uint32_t b) {
+		container& c = *containers[b];
+		ops::clean(c);
+		bench::do_not_optimize(c);
+	}));
+
+	refill_all();
+
+	add("iterate", bench::measure_ns(opts, batch, [] {}, [&](uint32_t b) {
+		uint64_t sum = 0;
+		for (const T& v : *containers[b])
+			sum += v.key;
+		bench::do_not_optimize(sum);
+	}));
+
+	add("copy", bench::measure_ns(opts, batch, [] {}, [&](uint32_t b) {
+		// heap-held like make(), a 65536 item inline container does not fit the stack
+		auto copy = std::make_unique<container>(*containers[b]);
+		bench::do_not_optimize(*copy);
+	}));
+
+	// moves take fresh full sources every batch, a moved-from container is not refilled in place
+	std::vector<std::unique_ptr<container>> sources(batch);
+	std::vector<std::unique_ptr<std::optional<container>>> constructed;
+	for (uint32_t i = 0; i < batch; ++i)
+		constructed.push_back(std::make_unique<std::optional<container>>());
+
+	auto make_sources = [&] {
+		for (auto& c : sources)
+		{
+			c = ops::make();
+			fill(*c);
+		}
+	};
+
+	add("move_construct", bench::measure_ns(opts, batch,
+		[&] {
+			make_sources();
+			for (auto& c : constructed)
+				c->reset();
+		},
+		[&](uint32_t b) {
+			// constructed in place, the timing doesn't include a heap allocation for the new container
+			constructed[b]->emplace(std::move(*sources[b]));
+			bench::do_not_optimize(**constructed[b]);
+		}));
+
+	// between two live containers: fixed_vector relocates the items into the buffer it already has, std::vector takes the other's
+	add("move_assign", bench::measure_ns(opts, batch,
+		[&] {
+			make_sources();
+			clean_all();
+		},
+		[&](uint32_t b) {
+			*containers[b] = std::move(*sources[b]);
+			bench::do_not_optimize(*containers[b]);
+		}));
+}
+
+template<class T, uint32_t capacity>
+void run_all_containers(const bench::options& opts, std::vector<bench::result>& results)
+{
+	run_container<fixed_vector_ops<T, capacity>, T, capacity>(opts, results);
+	run_container<std_vector_ops<T, capacity>, T, capacity>(opts, results);
+	run_container<std_array_ops<T, capacity>, T, capacity>(opts, results);
+	run_container<inline_fixed_vector_ops<T, capacity>, T, capacity>(opts, results);
+}
+
+template<class T>
+void run_capacities(const bench::options& opts, bool quick, std::vector<bench::result>& results)
+{
+	run_all_containers<T, 64>(opts, results);
+	run_all_containers<T, 4096>(opts, results);
+
+	if (!quick)
+		run_all_containers<T, 65536>(opts, results);
+}
+
+}
+
+/// Usage: bench [--quick] [output.json]
+/// Results are written as JSON to the file, or to stdout if no file is given
+int main(int argc, char* argv[])
+{
+	bool quick = false;
+	const char* output = nullptr;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--quick") == 0)
+			quick = true;
+		else
+			output = argv[i];
+	}
+
+	bench::options opts;
+	if (quick)
+	{
+		opts.samples = 3;
+		opts.min_sample_time = std::chrono::microseconds(200);
+	}
+
+	std::vector<bench::result> results;
+
+	run_capacities<payload<4>>(opts, quick, results);
+	run_capacities<payload<64>>(opts, quick, results);
+	run_capacities<payload<256>>(opts, quick, results);
+
+	if (output)
+	{
+		std::ofstream file(output);
+		if (!file)
+		{
+			std::cerr << "can't open " << output << '\n';
+			return 1;
+		}
+		bench::write_json(file, results);
+	}
+	else
+	{
+		bench::write_json(std::cout, results);
+	}
+
+	return 0;
+}
@@ -0,0 +1,119 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+/// <summary>
+/// Monotonic memory region. Memory is carved out of a caller-owned buffer by bumping a pointer,
+/// individual blocks are never freed, the whole region is released at once by reset().
+/// </summary>
+class arena
+{
+public:
+	/// <summary>
+	/// Ctor
+	/// </summary>
+	/// <param name="buffer"> - caller-owned memory region, must outlive the arena and every block taken from it</param>
+	/// <param name="size"> - size of the region in bytes</param>
+	arena(void* buffer, std::size_t size) noexcept;
+
+	arena(const arena&) = delete;
+	arena& operator=(const arena&) = delete;
+
+	/// <summary>
+	/// Take a block from the region. Throws std::bad_alloc if the region is exhausted
+	/// </summary>
+	/// <param name="size"> - size of the block in bytes</param>
+	/// <param name="alignment"> - alignment of the block, must be a power of two</param>
+	void* allocate(std::size_t size, std::size_t alignment);
+
+	/// <summary>
+	/// Release all blocks at once. Objects living in the region are not destroyed
+	/// </summary>
+	void reset() noexcept;
+
+	std::size_t used() const;
+	std::size_t capacity() const;
+
+private:
+	std::byte* begin_ = nullptr;
+	std::size_t capacity_ = 0;
+	std::size_t used_ = 0;
+};
+
+inline arena::arena(void* buffer, std::size_t size) noexcept
+	: begin_(static_cast<std::byte*>(buffer))
+	, capacity_(size)
+{
+	assert(buffer);
+}
+
+inline void* arena::allocate(std::size_t size, std::size_t alignment)
+{
+	void* p = begin_ + used_;
+	std::size_t space = capacity_ - used_;
+
+	if (!std::align(alignment, size, p, space))
+		throw std::bad_alloc();
+
+	used_ = capacity_ - space + size;
+	return p;
+}
+
+inline void arena::reset() noexcept
+{
+	used_ = 0;
+}
+
+inline std::size_t arena::used() const
+{
+	return used_;
+}
+
+inline std::size_t arena::capacity() const
+{
+	return capacity_;
+}
+
+/// <summary>
+/// Allocator taking memory blocks from an arena. deallocate() is a no-op, memory is reclaimed by arena::reset().
+/// The allocator is only a handle to the arena, so it is cheap to copy and default-constructible;
+/// a default-constructed allocator is unbound and must not allocate.
+/// </summary>
+/// <typeparam name="T">Items type</typeparam>
+template<class T>
+class arena_allocator
+{
+public:
+	using value_type = std::remove_cvref_t<T>;
+	using size_type = uint32_t;
+
+	arena_allocator() noexcept = default;
+	arena_allocator(arena& region) noexcept : arena_(&region) {}
+	~arena_allocator() noexcept = default;
+	arena_allocator(const arena_allocator&) noexcept = default;
+	arena_allocator(arena_allocator&&) noexcept = default;
+	arena_allocator& operator=(const arena_allocator&) noexcept = default;
+	arena_allocator& operator=(arena_allocator&&) noexcept = default;
+
+	inline value_type* allocate(size_type size)
+	{
+		assert(arena_);
+		return static_cast<value_type*>(arena_->allocate(size * sizeof(value_type), alignof(value_type)));
+	}
+
+	inline void deallocate([[maybe_unused]] value_type* p, size_type)
+	{
+		assert(p);
+	}
+
+	arena* get_arena() const { return arena_; }
+
+private:
+	arena* arena_ = nullptr;
+};
+static_assert(allocator_concept<arena_allocator<int>, int>);
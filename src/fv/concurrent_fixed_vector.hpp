@@ -0,0 +1,291 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+/// <summary>
+/// Fixed-capacity vector many threads may append to concurrently without locks.
+/// A slot is reserved by an atomic increment of the size counter, and every slot carries a publication flag
+/// which is raised once the item is fully constructed, so readers only see complete items.
+/// Removing items is not supported, clean() and iteration require all writers to be finished.
+/// </summary>
+/// <typeparam name="T">Items type</typeparam>
+/// <typeparam name="allocator_t">Allocator</typeparam>
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t = default_allocator<std::remove_cvref_t<T>>>
+class concurrent_fixed_vector
+{
+	static_assert(std::is_nothrow_move_constructible_v<allocator_t>, "Allocator must be nothrow move constructible");
+public:
+	using value_type = std::remove_cvref_t<T>;
+
+	using ref_type   = value_type&;
+	using cref_type  = value_type const&;
+	using rref_type  = value_type&&;
+
+	using ptr_type   = value_type*;
+	using cptr_type  = value_type const*;
+
+	using iterator = ptr_type;
+	using const_iterator = cptr_type;
+
+	using size_type = uint32_t;
+
+	/// <summary>
+	/// Ctor
+	/// </summary>
+	/// <param name="capacity"> - size of allocated memory block</param>
+	concurrent_fixed_vector(size_type capacity);
+
+	/// <summary>
+	/// Ctor with stateful allocator
+	/// </summary>
+	/// <param name="capacity"> - size of allocated memory block</param>
+	/// <param name="allocator"> - allocator instance the memory block is taken from</param>
+	concurrent_fixed_vector(size_type capacity, const allocator_t& allocator);
+	~concurrent_fixed_vector() noexcept;
+
+	concurrent_fixed_vector(const concurrent_fixed_vector&) = delete;
+	concurrent_fixed_vector& operator=(const concurrent_fixed_vector&) = delete;
+
+	/// <summary>
+	/// Add item to the end (copying). Thread-safe
+	/// </summary>
+	/// <returns>false if the vector is full</returns>
+	bool push_back(cref_type item);
+
+	/// <summary>
+	/// Add item to the end (moving). Thread-safe
+	/// </summary>
+	/// <returns>false if the vector is full</returns>
+	bool push_back(rref_type item);
+
+	/// <summary>
+	/// Emplacing item to the end. Thread-safe
+	/// </summary>
+	/// <returns>false if the vector is full</returns>
+	template<class... arg_type>
+	bool emplace_back(arg_type&&... arg);
+
+	/// <summary>
+	/// Check if item is fully constructed and may be read. Thread-safe
+	/// </summary>
+	bool published(size_type index) const;
+
+	/// <summary>
+	/// Destroy all items. Not thread-safe
+	/// </summary>
+	void clean();
+
+	/// <summary>
+	/// Access item. Item must be published
+	/// </summary>
+	cref_type operator[](size_type index) const;
+	ref_type  operator[](size_type index);
+
+	cref_type at(size_type index) const;
+	ref_type  at(size_type index);
+
+	/// <summary>
+	/// Number of reserved slots, including slots whose items are still being constructed
+	/// </summary>
+	size_type size() const;
+	size_type capacity() const;
+
+	bool full() const;
+	bool empty() const;
+
+	/// <summary>
+	/// Iterators may only be used when all writers are finished
+	/// </summary>
+	iterator begin();
+	iterator end();
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+private:
+	using flag_type = std::atomic<bool>;
+
+	allocator_t allocator_ = {};
+	default_allocator<flag_type> flag_allocator_ = {};
+
+	ptr_type data_ = nullptr;
+	flag_type* published_ = nullptr;
+	size_type capacity_ = 0;
+
+	// writers hammer the counter, keep it away from the fields readers load
+	alignas(64) std::atomic<uint64_t> reserved_ = 0;
+
+	void init_();
+};
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::concurrent_fixed_vector(size_type capacity)
+	: capacity_(capacity)
+{
+	init_();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::concurrent_fixed_vector(size_type capacity, const allocator_t& allocator)
+	: allocator_(allocator)
+	, capacity_(capacity)
+{
+	init_();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::~concurrent_fixed_vector() noexcept
+{
+	clean();
+
+	flag_allocator_.deallocate(published_, capacity_);
+	allocator_.deallocate(data_, capacity_);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void concurrent_fixed_vector<T, allocator_t>::init_()
+{
+	assert(capacity_ > 0);
+
+	published_ = flag_allocator_.allocate(capacity_);
+	assert(published_);
+
+	for (size_type i = 0; i < capacity_; ++i)
+		std::construct_at(&published_[i], false);
+
+	data_ = allocator_.allocate(capacity_);
+	assert(data_);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool concurrent_fixed_vector<T, allocator_t>::push_back(cref_type item)
+{
+	return emplace_back(item);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool concurrent_fixed_vector<T, allocator_t>::push_back(rref_type item)
+{
+	return emplace_back(std::move(item));
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+template<class ...arg_type>
+inline bool concurrent_fixed_vector<T, allocator_t>::emplace_back(arg_type&& ...arg)
+{
+	// cheap check first, so a full vector does not keep bumping the counter
+	if (reserved_.load(std::memory_order_relaxed) >= capacity_)
+		return false;
+
+	const uint64_t index = reserved_.fetch_add(1, std::memory_order_relaxed);
+	if (index >= capacity_)
+		return false;
+
+	std::construct_at(&data_[index], std::forward<arg_type>(arg)...);
+	published_[index].store(true, std::memory_order_release);
+
+	return true;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool concurrent_fixed_vector<T, allocator_t>::published(size_type index) const
+{
+	assert(index < capacity_);
+	return published_[index].load(std::memory_order_acquire);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void concurrent_fixed_vector<T, allocator_t>::clean()
+{
+	const size_type count = size();
+	for (size_type i = 0; i < count; ++i)
+	{
+		// slot may be reserved but never published if the item ctor threw
+		if (published_[i].load(std::memory_order_acquire))
+		{
+			std::destroy_at(&data_[i]);
+			published_[i].store(false, std::memory_order_relaxed);
+		}
+	}
+
+	reserved_.store(0, std::memory_order_relaxed);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::cref_type concurrent_fixed_vector<T, allocator_t>::operator[](size_type index) const
+{
+	return data_[index];
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::ref_type concurrent_fixed_vector<T, allocator_t>::operator[](size_type index)
+{
+	return data_[index];
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::cref_type concurrent_fixed_vector<T, allocator_t>::at(size_type index) const
+{
+	assert(published(index));
+	return data_[index];
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::ref_type concurrent_fixed_vector<T, allocator_t>::at(size_type index)
+{
+	assert(published(index));
+	return data_[index];
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::size_type concurrent_fixed_vector<T, allocator_t>::size() const
+{
+	// failed reservations of a full vector push the counter past capacity
+	const uint64_t reserved = reserved_.load(std::memory_order_relaxed);
+	return reserved < capacity_ ? static_cast<size_type>(reserved) : capacity_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::size_type concurrent_fixed_vector<T, allocator_t>::capacity() const
+{
+	return capacity_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool concurrent_fixed_vector<T, allocator_t>::full() const
+{
+	return size() == capacity_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool concurrent_fixed_vector<T, allocator_t>::empty() const
+{
+	return size() == 0;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::iterator concurrent_fixed_vector<T, allocator_t>::begin()
+{
+	return data_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::iterator concurrent_fixed_vector<T, allocator_t>::end()
+{
+	return data_ + size();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::const_iterator concurrent_fixed_vector<T, allocator_t>::begin() const
+{
+	return data_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline concurrent_fixed_vector<T, allocator_t>::const_iterator concurrent_fixed_vector<T, allocator_t>::end() const
+{
+	return data_ + size();
+}
@@ -0,0 +1,507 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+/// <summary>
+/// Fixed-capacity FIFO ring buffer. Memory is allocated once on construction and never reallocated.
+/// Capacity must be a power of two, head and tail are free-running counters indexed modulo capacity.
+/// </summary>
+/// <typeparam name="T">Items type</typeparam>
+/// <typeparam name="allocator_t">Allocator</typeparam>
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t = default_allocator<std::remove_cvref_t<T>>>
+class fixed_ring
+{
+	static_assert(std::is_nothrow_move_constructible_v<allocator_t>, "Allocator must be nothrow move constructible");
+public:
+	using value_type = std::remove_cvref_t<T>;
+
+	using ref_type   = value_type&;
+	using cref_type  = value_type const&;
+	using rref_type  = value_type&&;
+
+	using ptr_type   = value_type*;
+	using cptr_type  = value_type const*;
+
+	using size_type = uint32_t;
+
+	/// <summary>
+	/// Ctor
+	/// </summary>
+	/// <param name="capacity"> - size of allocated memory block, power of two</param>
+	fixed_ring(size_type capacity);
+
+	/// <summary>
+	/// Ctor with stateful allocator
+	/// </summary>
+	/// <param name="capacity"> - size of allocated memory block, power of two</param>
+	/// <param name="allocator"> - allocator instance the memory block is taken from</param>
+	fixed_ring(size_type capacity, const allocator_t& allocator);
+	~fixed_ring() noexcept;
+
+	/// <summary>
+	/// Copy ctor
+	/// </summary>
+	fixed_ring(const fixed_ring& other);
+
+	/// <summary>
+	/// Move ctor
+	/// </summary>
+	fixed_ring(fixed_ring&& other) noexcept;
+
+	fixed_ring& operator=(const fixed_ring&) = delete;
+	fixed_ring& operator=(fixed_ring&&) = delete;
+
+	/// <summary>
+	/// Add item to the back (copying)
+	/// </summary>
+	void push_back(cref_type item);
+
+	/// <summary>
+	/// Add item to the back (moving)
+	/// </summary>
+	void push_back(rref_type item);
+
+	/// <summary>
+	/// Emplacing item to the back
+	/// </summary>
+	template<class... arg_type>
+	void emplace_back(arg_type&&... arg);
+
+	/// <summary>
+	/// Destroy the front item
+	/// </summary>
+	void pop_front();
+
+	/// <summary>
+	/// Destroy all items
+	/// </summary>
+	void clean();
+
+	cref_type front() const;
+	ref_type  front();
+
+	cref_type back() const;
+	ref_type  back();
+
+	/// <summary>
+	/// Access item by position counted from the front
+	/// </summary>
+	cref_type operator[](size_type index) const;
+	ref_type  operator[](size_type index);
+
+	size_type size() const;
+	size_type capacity() const;
+
+	bool full() const;
+	bool empty() const;
+
+private:
+	allocator_t allocator_ = {};
+
+	ptr_type data_ = nullptr;
+	size_type capacity_ = 0;
+	size_type head_ = 0;
+	size_type tail_ = 0;
+
+	void allocate_(size_type capacity);
+	ptr_type slot_(size_type counter) const;
+};
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::fixed_ring(size_type capacity)
+{
+	allocate_(capacity);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::fixed_ring(size_type capacity, const allocator_t& allocator)
+	: allocator_(allocator)
+{
+	allocate_(capacity);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::~fixed_ring() noexcept
+{
+	if (data_)
+	{
+		clean();
+		allocator_.deallocate(data_, capacity_);
+	}
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::fixed_ring(const fixed_ring& other)
+	: allocator_(other.allocator_)
+{
+	allocate_(other.capacity_);
+
+	for (size_type i = 0; i < other.size(); ++i)
+		push_back(other[i]);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::fixed_ring(fixed_ring&& other) noexcept
+	: allocator_(std::move(other.allocator_))
+	, data_(std::exchange(other.data_, nullptr))
+	, capacity_(std::exchange(other.capacity_, 0))
+	, head_(std::exchange(other.head_, 0))
+	, tail_(std::exchange(other.tail_, 0))
+{
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void fixed_ring<T, allocator_t>::push_back(cref_type item)
+{
+	emplace_back(item);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void fixed_ring<T, allocator_t>::push_back(rref_type item)
+{
+	emplace_back(std::move(item));
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+template<class ...arg_type>
+inline void fixed_ring<T, allocator_t>::emplace_back(arg_type&& ...arg)
+{
+	assert(data_);
+	assert(!full());
+
+	std::construct_at(slot_(tail_), std::forward<arg_type>(arg)...);
+	++tail_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void fixed_ring<T, allocator_t>::pop_front()
+{
+	assert(!empty());
+
+	std::destroy_at(slot_(head_));
+	++head_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void fixed_ring<T, allocator_t>::clean()
+{
+	while (!empty())
+		pop_front();
+
+	head_ = tail_ = 0;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::cref_type fixed_ring<T, allocator_t>::front() const
+{
+	assert(!empty());
+	return *slot_(head_);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::ref_type fixed_ring<T, allocator_t>::front()
+{
+	assert(!empty());
+	return *slot_(head_);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::cref_type fixed_ring<T, allocator_t>::back() const
+{
+	assert(!empty());
+	return *slot_(tail_ - 1);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::ref_type fixed_ring<T, allocator_t>::back()
+{
+	assert(!empty());
+	return *slot_(tail_ - 1);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::cref_type fixed_ring<T, allocator_t>::operator[](size_type index) const
+{
+	assert(index < size());
+	return *slot_(head_ + index);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::ref_type fixed_ring<T, allocator_t>::operator[](size_type index)
+{
+	assert(index < size());
+	return *slot_(head_ + index);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::size_type fixed_ring<T, allocator_t>::size() const
+{
+	return tail_ - head_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::size_type fixed_ring<T, allocator_t>::capacity() const
+{
+	return capacity_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool fixed_ring<T, allocator_t>::full() const
+{
+	return size() == capacity_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool fixed_ring<T, allocator_t>::empty() const
+{
+	return head_ == tail_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void fixed_ring<T, allocator_t>::allocate_(size_type capacity)
+{
+	assert(capacity > 0);
+	assert(std::has_single_bit(capacity));
+
+	data_ = allocator_.allocate(capacity);
+	assert(data_);
+
+	capacity_ = capacity;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_ring<T, allocator_t>::ptr_type fixed_ring<T, allocator_t>::slot_(size_type counter) const
+{
+	return data_ + (counter & (capacity_ - 1));
+}
+
+/// <summary>
+/// Wait-free single-producer/single-consumer ring buffer. One thread may push while another one pops.
+/// Head and tail live on separate cache lines, and each side keeps a cached copy of the other side's index,
+/// so the shared indices are only reloaded when the ring looks full or empty.
+/// </summary>
+/// <typeparam name="T">Items type</typeparam>
+/// <typeparam name="allocator_t">Allocator</typeparam>
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t = default_allocator<std::remove_cvref_t<T>>>
+class spsc_fixed_ring
+{
+	static_assert(std::is_nothrow_move_constructible_v<allocator_t>, "Allocator must be nothrow move constructible");
+public:
+	using value_type = std::remove_cvref_t<T>;
+
+	using ref_type   = value_type&;
+	using cref_type  = value_type const&;
+	using rref_type  = value_type&&;
+
+	using ptr_type   = value_type*;
+
+	using size_type = uint32_t;
+
+	static constexpr std::size_t cache_line_size = 64;
+
+	/// <summary>
+	/// Ctor
+	/// </summary>
+	/// <param name="capacity"> - size of allocated memory block, power of two</param>
+	spsc_fixed_ring(size_type capacity);
+
+	/// <summary>
+	/// Ctor with stateful allocator
+	/// </summary>
+	/// <param name="capacity"> - size of allocated memory block, power of two</param>
+	/// <param name="allocator"> - allocator instance the memory block is taken from</param>
+	spsc_fixed_ring(size_type capacity, const allocator_t& allocator);
+	~spsc_fixed_ring() noexcept;
+
+	spsc_fixed_ring(const spsc_fixed_ring&) = delete;
+	spsc_fixed_ring& operator=(const spsc_fixed_ring&) = delete;
+
+	/// <summary>
+	/// Add item to the back (copying). Producer only
+	/// </summary>
+	/// <returns>false if the ring is full</returns>
+	bool try_push(cref_type item);
+
+	/// <summary>
+	/// Add item to the back (moving). Producer only
+	/// </summary>
+	/// <returns>false if the ring is full</returns>
+	bool try_push(rref_type item);
+
+	/// <summary>
+	/// Emplacing item to the back. Producer only
+	/// </summary>
+	/// <returns>false if the ring is full</returns>
+	template<class... arg_type>
+	bool try_emplace(arg_type&&... arg);
+
+	/// <summary>
+	/// Move the front item out and destroy it. Consumer only
+	/// </summary>
+	/// <returns>false if the ring is empty</returns>
+	bool try_pop(ref_type item);
+
+	/// <summary>
+	/// Front item or nullptr if the ring is empty. Consumer only, the item stays valid until pop()
+	/// </summary>
+	ptr_type front();
+
+	/// <summary>
+	/// Destroy the front item, the ring must not be empty. Consumer only
+	/// </summary>
+	void pop();
+
+	/// <summary>
+	/// Approximate number of items, exact only when called by one of the sides. Never more than capacity(), also from other threads
+	/// </summary>
+	size_type size() const;
+	size_type capacity() const;
+
+	bool empty() const;
+
+private:
+	allocator_t allocator_ = {};
+
+	ptr_type data_ = nullptr;
+	size_type mask_ = 0;
+
+	// consumer side
+	alignas(cache_line_size) std::atomic<size_type> head_ = 0;
+	size_type cached_tail_ = 0;
+
+	// producer side
+	alignas(cache_line_size) std::atomic<size_type> tail_ = 0;
+	size_type cached_head_ = 0;
+
+	void allocate_(size_type capacity);
+};
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline spsc_fixed_ring<T, allocator_t>::spsc_fixed_ring(size_type capacity)
+{
+	allocate_(capacity);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline spsc_fixed_ring<T, allocator_t>::spsc_fixed_ring(size_type capacity, const allocator_t& allocator)
+	: allocator_(allocator)
+{
+	allocate_(capacity);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline spsc_fixed_ring<T, allocator_t>::~spsc_fixed_ring() noexcept
+{
+	while (front())
+		pop();
+
+	allocator_.deallocate(data_, mask_ + 1);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool spsc_fixed_ring<T, allocator_t>::try_push(cref_type item)
+{
+	return try_emplace(item);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool spsc_fixed_ring<T, allocator_t>::try_push(rref_type item)
+{
+	return try_emplace(std::move(item));
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+template<class ...arg_type>
+inline bool spsc_fixed_ring<T, allocator_t>::try_emplace(arg_type&& ...arg)
+{
+	const size_type tail = tail_.load(std::memory_order_relaxed);
+
+	if (tail - cached_head_ > mask_)
+	{
+		cached_head_ = head_.load(std::memory_order_acquire);
+		if (tail - cached_head_ > mask_)
+			return false;
+	}
+
+	std::construct_at(data_ + (tail & mask_), std::forward<arg_type>(arg)...);
+	tail_.store(tail + 1, std::memory_order_release);
+
+	return true;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool spsc_fixed_ring<T, allocator_t>::try_pop(ref_type item)
+{
+	ptr_type p = front();
+	if (!p)
+		return false;
+
+	item = std::move(*p);
+	pop();
+
+	return true;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline spsc_fixed_ring<T, allocator_t>::ptr_type spsc_fixed_ring<T, allocator_t>::front()
+{
+	const size_type head = head_.load(std::memory_order_relaxed);
+
+	if (head == cached_tail_)
+	{
+		cached_tail_ = tail_.load(std::memory_order_acquire);
+		if (head == cached_tail_)
+			return nullptr;
+	}
+
+	return data_ + (head & mask_);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void spsc_fixed_ring<T, allocator_t>::pop()
+{
+	const size_type head = head_.load(std::memory_order_relaxed);
+	assert(head != cached_tail_);
+
+	std::destroy_at(data_ + (head & mask_));
+	head_.store(head + 1, std::memory_order_release);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline spsc_fixed_ring<T, allocator_t>::size_type spsc_fixed_ring<T, allocator_t>::size() const
+{
+	// head first: tail only grows, so it can't be read behind the head and wrap the difference around.
+	// Both sides may move between the loads, a monitor thread gets at most capacity()
+	const size_type head = head_.load(std::memory_order_acquire);
+	const size_type tail = tail_.load(std::memory_order_acquire);
+	return std::min(size_type(tail - head), capacity());
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline spsc_fixed_ring<T, allocator_t>::size_type spsc_fixed_ring<T, allocator_t>::capacity() const
+{
+	return mask_ + 1;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool spsc_fixed_ring<T, allocator_t>::empty() const
+{
+	return size() == 0;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void spsc_fixed_ring<T, allocator_t>::allocate_(size_type capacity)
+{
+	assert(capacity > 0);
+	assert(std::has_single_bit(capacity));
+
+	data_ = allocator_.allocate(capacity);
+	assert(data_);
+
+	mask_ = capacity - 1;
+}
@@ -0,0 +1,305 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+
+#include <cstdint>
+
+/// <summary>
+/// Stable reference to an item of fixed_slot_map. Handle of an erased item never becomes valid again
+/// (until its generation counter wraps around)
+/// </summary>
+struct slot_handle
+{
+	static constexpr uint32_t invalid_index = UINT32_MAX;
+
+	uint32_t index = invalid_index;
+	uint32_t generation = 0;
+
+	bool operator==(const slot_handle&) const = default;
+};
+
+/// <summary>
+/// Fixed-capacity container with stable handles. Items are kept densely in fixed_vector and removed by swap-and-pop,
+/// a sparse table with generation counters maps handles to dense positions.
+/// Insert, erase and lookup by handle are O(1), iteration goes over the dense items in no particular order.
+/// </summary>
+/// <typeparam name="T">Items type</typeparam>
+/// <typeparam name="allocator_t">Allocator of items</typeparam>
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t = default_allocator<std::remove_cvref_t<T>>>
+class fixed_slot_map
+{
+public:
+	using values_type = fixed_vector<T, allocator_t>;
+
+	using value_type = typename values_type::value_type;
+
+	using ref_type   = value_type&;
+	using cref_type  = value_type const&;
+	using rref_type  = value_type&&;
+
+	using ptr_type   = value_type*;
+	using cptr_type  = value_type const*;
+
+	using iterator = typename values_type::iterator;
+	using const_iterator = typename values_type::const_iterator;
+
+	using size_type = uint32_t;
+
+	/// <summary>
+	/// Ctor
+	/// </summary>
+	/// <param name="capacity"> - max number of items</param>
+	fixed_slot_map(size_type capacity);
+
+	/// <summary>
+	/// Add item (copying)
+	/// </summary>
+	slot_handle insert(cref_type item);
+
+	/// <summary>
+	/// Add item (moving)
+	/// </summary>
+	slot_handle insert(rref_type item);
+
+	/// <summary>
+	/// Emplacing item
+	/// </summary>
+	template<class... arg_type>
+	slot_handle emplace(arg_type&&... arg);
+
+	/// <summary>
+	/// Remove item. The last dense item takes its place, handles of all other items stay valid
+	/// </summary>
+	/// <returns>false if handle is not valid</returns>
+	bool erase(slot_handle handle);
+
+	/// <summary>
+	/// Destroy all items, invalidates all handles
+	/// </summary>
+	void clean();
+
+	bool contains(slot_handle handle) const;
+
+	/// <summary>
+	/// Item by handle, nullptr if handle is not valid
+	/// </summary>
+	ptr_type find(slot_handle handle);
+	cptr_type find(slot_handle handle) const;
+
+	/// <summary>
+	/// Item by handle, handle must be valid
+	/// </summary>
+	cref_type at(slot_handle handle) const;
+	ref_type  at(slot_handle handle);
+
+	/// <summary>
+	/// Handle of the item at dense position
+	/// </summary>
+	slot_handle handle_of(size_type dense_index) const;
+
+	size_type size() const;
+	size_type capacity() const;
+
+	bool full() const;
+	bool empty() const;
+
+	iterator begin();
+	iterator end();
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+private:
+	struct slot
+	{
+		// dense position of the item, or next free slot when the slot is free
+		size_type dense_or_next = 0;
+		// odd while the slot is occupied
+		uint32_t generation = 0;
+		// sparse slot owning the dense item with the same index as this slot
+		size_type owner = 0;
+	};
+
+	values_type values_;
+	fixed_vector<slot> slots_;
+	size_type free_head_ = 0;
+
+	bool valid_(slot_handle handle) const;
+};
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_slot_map<T, allocator_t>::fixed_slot_map(size_type capacity)
+	: values_(capacity)
+	, slots_(capacity)
+{
+	for (size_type i = 0; i < capacity; ++i)
+		slots_.push_back(slot{ i + 1, 0, 0 });
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline slot_handle fixed_slot_map<T, allocator_t>::insert(cref_type item)
+{
+	return emplace(item);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline slot_handle fixed_slot_map<T, allocator_t>::insert(rref_type item)
+{
+	return emplace(std::move(item));
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+template<class ...arg_type>
+inline slot_handle fixed_slot_map<T, allocator_t>::emplace(arg_type&& ...arg)
+{
+	assert(!full());
+
+	values_.emplace_back(std::forward<arg_type>(arg)...);
+
+	const size_type index = free_head_;
+	const size_type dense = values_.size() - 1;
+
+	slot& s = slots_[index];
+	free_head_ = s.dense_or_next;
+	s.dense_or_next = dense;
+	++s.generation;
+
+	slots_[dense].owner = index;
+
+	return slot_handle{ index, s.generation };
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool fixed_slot_map<T, allocator_t>::erase(slot_handle handle)
+{
+	if (!valid_(handle))
+		return false;
+
+	slot& s = slots_[handle.index];
+	const size_type dense = s.dense_or_next;
+	const size_type last = values_.size() - 1;
+
+	// mirror the swap fixed_vector::remove is about to do
+	if (dense != last)
+	{
+		const size_type moved_owner = slots_[last].owner;
+		slots_[moved_owner].dense_or_next = dense;
+		slots_[dense].owner = moved_owner;
+	}
+	values_.remove(dense);
+
+	++s.generation;
+	s.dense_or_next = free_head_;
+	free_head_ = handle.index;
+
+	return true;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void fixed_slot_map<T, allocator_t>::clean()
+{
+	for (size_type dense = 0; dense < values_.size(); ++dense)
+	{
+		slot& s = slots_[slots_[dense].owner];
+		++s.generation;
+		s.dense_or_next = free_head_;
+		free_head_ = slots_[dense].owner;
+	}
+
+	values_.clean();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool fixed_slot_map<T, allocator_t>::contains(slot_handle handle) const
+{
+	return valid_(handle);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_slot_map<T, allocator_t>::ptr_type fixed_slot_map<T, allocator_t>::find(slot_handle handle)
+{
+	return valid_(handle) ? &values_[slots_[handle.index].dense_or_next] : nullptr;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_slot_map<T, allocator_t>::cptr_type fixed_slot_map<T, allocator_t>::find(slot_handle handle) const
+{
+	return valid_(handle) ? &values_[slots_[handle.index].dense_or_next] : nullptr;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_slot_map<T, allocator_t>::cref_type fixed_slot_map<T, allocator_t>::at(slot_handle handle) const
+{
+	assert(valid_(handle));
+	return values_[slots_[handle.index].dense_or_next];
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_slot_map<T, allocator_t>::ref_type fixed_slot_map<T, allocator_t>::at(slot_handle handle)
+{
+	assert(valid_(handle));
+	return values_[slots_[handle.index].dense_or_next];
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline slot_handle fixed_slot_map<T, allocator_t>::handle_of(size_type dense_index) const
+{
+	assert(dense_index < values_.size());
+
+	const size_type index = slots_[dense_index].owner;
+	return slot_handle{ index, slots_[index].generation };
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_slot_map<T, allocator_t>::size_type fixed_slot_map<T, allocator_t>::size() const
+{
+	return values_.size();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_slot_map<T, allocator_t>::size_type fixed_slot_map<T, allocator_t>::capacity() const
+{
+	return values_.capacity();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool fixed_slot_map<T, allocator_t>::full() const
+{
+	return values_.full();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool fixed_slot_map<T, allocator_t>::empty() const
+{
+	return values_.empty();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_slot_map<T, allocator_t>::iterator fixed_slot_map<T, allocator_t>::begin()
+{
+	return values_.begin();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_slot_map<T, allocator_t>::iterator fixed_slot_map<T, allocator_t>::end()
+{
+	return values_.end();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_slot_map<T, allocator_t>::const_iterator fixed_slot_map<T, allocator_t>::begin() const
+{
+	return values_.begin();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline fixed_slot_map<T, allocator_t>::const_iterator fixed_slot_map<T, allocator_t>::end() const
+{
+	return values_.end();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool fixed_slot_map<T, allocator_t>::valid_(slot_handle handle) const
+{
+	return handle.index < slots_.size() && slots_[handle.index].generation == handle.generation && (handle.generation & 1);
+}
@@ -1,10 +1,23 @@
-﻿#include <cstdint>
+﻿#pragma once
+
+#include <cstdint>
+#include <cstddef>
 #include <concepts>
 #include <type_traits>
 #include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <utility>
 #include <iterator>
+#include <new>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "simd.hpp"
 
 
 template<class allocator_type, class value_type>
@@ -16,6 +29,38 @@ requires (allocator_type allocator, value_type* p, uint32_t size)
 	{ allocator.deallocate(p, size) };
 };
 
+/// <summary>
+/// Allocator which can give the memory of no longer used items back to the OS without releasing the block.
+/// fixed_vector::clean() calls discard() for the range it has just destroyed
+/// </summary>
+template<class allocator_type, class value_type>
+concept discarding_allocator_concept = allocator_concept<allocator_type, value_type> &&
+requires (allocator_type allocator, value_type* p, uint32_t size)
+{
+	{ allocator.discard(p, size) };
+};
+
+/// <summary>
+/// Change of the vector's size reported to an observing allocator
+/// </summary>
+enum class container_event : uint8_t
+{
+	push,
+	remove,
+	clean,
+};
+
+/// <summary>
+/// Allocator which is told how the vector holding its block is used.
+/// fixed_vector calls observe(event, count, size, capacity) after every change of its size, with the number of added or removed items
+/// </summary>
+template<class allocator_type, class value_type>
+concept observing_allocator_concept = allocator_concept<allocator_type, value_type> &&
+requires (allocator_type allocator, uint32_t count, uint32_t size, uint32_t capacity)
+{
+	{ allocator.observe(container_event::push, count, size, capacity) };
+};
+
 template<class T>
 class default_allocator
 {
@@ -46,16 +91,119 @@ private:
 };
 static_assert(allocator_concept<default_allocator<void>, void>);
 
+/// <summary>
+/// Tells that an object may be moved to another address by copying its bytes, with the source treated as destroyed.
+/// True for trivially copyable types, specialize it for types like std::unique_ptr wrappers.
+/// </summary>
+template<class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template<class T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+namespace fv_detail
+{
+
+/// <summary>
+/// Copy-construct count items into uninitialized memory, as a single block copy for trivially copyable types
+/// </summary>
+template<class T>
+inline void uninitialized_copy_n(const T* src, uint32_t count, T* dst)
+{
+	if constexpr (std::is_trivially_copyable_v<T>)
+	{
+		if (count)
+			std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), std::size_t(count) * sizeof(T));
+	}
+	else
+	{
+		std::uninitialized_copy_n(src, count, dst);
+	}
+}
+
+/// <summary>
+/// Move count items into uninitialized memory and destroy the sources,
+/// as a single block copy for trivially relocatable types
+/// </summary>
+template<class T>
+inline void uninitialized_relocate_n(T* src, uint32_t count, T* dst)
+{
+	if constexpr (is_trivially_relocatable_v<T>)
+	{
+		if (count)
+			std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), std::size_t(count) * sizeof(T));
+	}
+	else
+	{
+		std::uninitialized_move_n(src, count, dst);
+		std::destroy_n(src, count);
+	}
+}
+
+}
+
+/// <summary>
+/// Overflow policy: push_back and emplace_back on a full vector is a precondition violation checked by assert only.
+/// No check at all in release builds
+/// </summary>
+struct overflow_assert {};
+
+/// <summary>
+/// Overflow policy: push_back and emplace_back on a full vector throw std::length_error
+/// </summary>
+struct overflow_throw {};
+
+/// <summary>
+/// Overflow policy: push_back and emplace_back on a full vector discard the new item
+/// </summary>
+struct overflow_drop_newest {};
+
+/// <summary>
+/// Overflow policy: push_back and emplace_back on a full vector erase the first item, shifting the rest left, and append the new one.
+/// O(n) per overflow, use fixed_ring when overwriting the oldest item is the common case
+/// </summary>
+struct overflow_overwrite_oldest {};
+
+/// <summary>
+/// Overflow policy: push_back and emplace_back on a full vector move the new item to a heap-backed overflow buffer, see fixed_vector::spilled()
+/// </summary>
+struct overflow_spill {};
+
+template<class policy_t>
+concept overflow_policy = std::same_as<policy_t, overflow_assert> || std::same_as<policy_t, overflow_throw> ||
+	std::same_as<policy_t, overflow_drop_newest> || std::same_as<policy_t, overflow_overwrite_oldest> || std::same_as<policy_t, overflow_spill>;
+
+namespace fv_detail
+{
+
+/// <summary>
+/// State an overflow policy keeps in the vector: the overflow buffer for overflow_spill, nothing (empty base) for the rest
+/// </summary>
+template<class policy_t, class T>
+struct overflow_storage {};
+
+template<class T>
+struct overflow_storage<overflow_spill, T>
+{
+	std::vector<T> spilled;
+};
+
+}
+
 /// <summary>
 /// Fixed-capacity vector. Memory is allocated once on construction and never reallocated.
 /// May allocate a new buffer only when copying or moving from another vector with larger capacity.
 /// </summary>
 /// <typeparam name="T">Items type</typeparam>
 /// <typeparam name="allocator_t">Allocator</typeparam>
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t = default_allocator<std::remove_cvref_t<T>>>
-class fixed_vector
+/// <typeparam name="overflow_t">What push_back and emplace_back do when the vector is full, overflow_assert by default</typeparam>
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t = default_allocator<std::remove_cvref_t<T>>, class overflow_t = overflow_assert>
+class fixed_vector : private fv_detail::overflow_storage<overflow_t, std::remove_cvref_t<T>>
 {
 	static_assert(std::is_nothrow_move_constructible_v<allocator_t>, "Allocator must be nothrow move constructible");
+	static_assert(overflow_policy<overflow_t>, "Unknown overflow policy");
+
+	using overflow_storage_t = fv_detail::overflow_storage<overflow_t, std::remove_cvref_t<T>>;
 public:
 	using value_type = std::remove_cvref_t<T>;
 
@@ -78,6 +226,13 @@ public:
 	/// </summary>
 	/// <param name="capacity"> - size of allocated memory block</param>
 	fixed_vector(size_type capacity);
+
+	/// <summary>
+	/// Ctor with stateful allocator
+	/// </summary>
+	/// <param name="capacity"> - size of allocated memory block</param>
+	/// <param name="allocator"> - allocator instance the memory block is taken from</param>
+	fixed_vector(size_type capacity, const allocator_t& allocator);
 	~fixed_vector() noexcept;
 
 	/// <summary>
@@ -101,22 +256,77 @@ public:
 	fixed_vector& operator=(fixed_vector&& other) noexcept;
 
 	/// <summary>
-	/// Add item to the end (copying)
+	/// Add item to the end (copying). A full vector is handled by the overflow policy
 	/// </summary>
 	void push_back(cref_type item);
 
 	/// <summary>
-	/// Add item to the end (moving)
+	/// Add item to the end (moving). A full vector is handled by the overflow policy
 	/// </summary>
 	void push_back(rref_type item);
 
 
 	/// <summary>
-	/// Emplacing item to the end
+	/// Emplacing item to the end. A full vector is handled by the overflow policy
 	/// </summary>
 	template<class... arg_type>
 	void emplace_back(arg_type&&... arg);
 
+	/// <summary>
+	/// Add item to the end if the vector is not full, whatever the overflow policy
+	/// </summary>
+	/// <returns>false if the vector is full</returns>
+	bool try_push_back(cref_type item);
+	bool try_push_back(rref_type item);
+
+	/// <summary>
+	/// Emplacing item to the end if the vector is not full, whatever the overflow policy. Arguments are not used if it is full
+	/// </summary>
+	/// <returns>false if the vector is full</returns>
+	template<class... arg_type>
+	bool try_emplace_back(arg_type&&... arg);
+
+	/// <summary>
+	/// Items which did not fit, in the order they came. They are not part of size() or iteration and are dropped by clean()
+	/// </summary>
+	std::span<value_type> spilled() requires std::same_as<overflow_t, overflow_spill>;
+	std::span<const value_type> spilled() const requires std::same_as<overflow_t, overflow_spill>;
+
+	/// <summary>
+	/// Add copies of items to the end. Capacity is checked once, trivially copyable items are copied as a single block
+	/// </summary>
+	void insert_back(std::span<const value_type> items);
+
+	/// <summary>
+	/// Add items of the range to the end. Capacity is checked once, contiguous ranges go through insert_back
+	/// </summary>
+	template<std::ranges::input_range range_t>
+		requires std::ranges::sized_range<range_t> || std::ranges::forward_range<range_t>
+	void append_range(range_t&& range);
+
+	/// <summary>
+	/// Replace all items with copies of [first, last)
+	/// </summary>
+	template<std::forward_iterator iterator_t, std::sentinel_for<iterator_t> sentinel_t>
+	void assign(iterator_t first, sentinel_t last);
+
+	/// <summary>
+	/// Add count copies of value to the end
+	/// </summary>
+	void push_back_n(size_type count, cref_type value);
+
+	/// <summary>
+	/// Add count default-initialized items to the end and return them, so producers can write directly into the buffer.
+	/// Items of trivially default constructible types are left uninitialized
+	/// </summary>
+	std::span<value_type> append_default_init(size_type count);
+
+	/// <summary>
+	/// Change size to new_size. New items are default-initialized (left uninitialized for trivial types) and returned,
+	/// items past new_size are destroyed
+	/// </summary>
+	std::span<value_type> resize_uninitialized(size_type new_size);
+
 	/// <summary>
 	/// Remove item. If index != size()-1, then item will be swapped with the last item and only then last item destroyed
 	/// </summary>
@@ -124,7 +334,40 @@ public:
 	void remove(size_type index);
 
 	/// <summary>
-	/// Destroy all items
+	/// Remove item and shift the following items left, keeping their order.
+	/// Trivially relocatable items are shifted with a single memmove
+	/// </summary>
+	/// <param name="index"> - index of removing item</param>
+	void erase(size_type index);
+
+	/// <summary>
+	/// Remove items [first, last) and shift the following items left, keeping their order
+	/// </summary>
+	void erase(size_type first, size_type last);
+
+	/// <summary>
+	/// Remove items at the given indices in one pass, keeping the order of the rest.
+	/// Indices must be sorted in strictly ascending order
+	/// </summary>
+	void erase_indices(std::span<const size_type> indices);
+
+	/// <summary>
+	/// Remove all items matching pred in one pass, keeping the order of the rest.
+	/// compare_with predicates on arithmetic items are evaluated with SIMD compress kernels
+	/// </summary>
+	/// <returns>number of removed items</returns>
+	template<class predicate_t>
+	size_type remove_if(predicate_t&& pred);
+
+	/// <summary>
+	/// Remove all items matching pred. Like remove(), every hole is filled with the last item, so the order is not kept
+	/// </summary>
+	/// <returns>number of removed items</returns>
+	template<class predicate_t>
+	size_type remove_if_unordered(predicate_t&& pred);
+
+	/// <summary>
+	/// Destroy all items. Memory of destroyed items is discarded if the allocator satisfies discarding_allocator_concept
 	/// </summary>
 	void clean();
 
@@ -140,6 +383,36 @@ public:
 	bool full() const;
 	bool empty() const;
 
+	/// <summary>
+	/// Allocator the block was taken from. Copies of it may be used for temporary buffers tied to the same memory source
+	/// </summary>
+	const allocator_t& get_allocator() const;
+
+	/// <summary>
+	/// First item equal to value or end(). Items are compared with SIMD kernels chosen by the CPU at runtime
+	/// </summary>
+	const_iterator find(value_type value) const requires fv_detail::simd::simd_item<value_type>;
+	iterator find(value_type value) requires fv_detail::simd::simd_item<value_type>;
+
+	/// <summary>
+	/// Number of items equal to value (SIMD)
+	/// </summary>
+	size_type count(value_type value) const requires fv_detail::simd::simd_item<value_type>;
+
+	bool contains(value_type value) const requires fv_detail::simd::simd_item<value_type>;
+
+	/// <summary>
+	/// Smallest and largest items (SIMD). Vector must not be empty, result is unspecified if items contain NaN
+	/// </summary>
+	value_type min() const requires fv_detail::simd::simd_item<value_type>;
+	value_type max() const requires fv_detail::simd::simd_item<value_type>;
+	std::pair<value_type, value_type> minmax() const requires fv_detail::simd::simd_item<value_type>;
+
+	/// <summary>
+	/// Sum of items (SIMD). Integers are summed in 64 bits, floating point items in their own type
+	/// </summary>
+	fv_detail::simd::sum_type<value_type> sum() const requires fv_detail::simd::simd_item<value_type>;
+
 	iterator begin();
 	iterator end();
 
@@ -163,14 +436,30 @@ private:
 	size_type size_ = 0;
 
 	void release_();
+	void observe_(container_event event, size_type count);
+
+	template<class... arg_type>
+	void overflow_(arg_type&&... arg);
 
 	template<class fv_t, class tranfsfer_fn>
-		requires std::same_as<std::remove_cvref_t<fv_t>, fixed_vector<T, allocator_t>>
-	fixed_vector<T, allocator_t>& copy_or_move_assignment_(fv_t&& other, tranfsfer_fn&& transfer_strategy);
+		requires std::same_as<std::remove_cvref_t<fv_t>, fixed_vector<T, allocator_t, overflow_t>>
+	fixed_vector<T, allocator_t, overflow_t>& copy_or_move_assignment_(fv_t&& other, tranfsfer_fn&& transfer_strategy);
 };
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::fixed_vector(size_type capacity)
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::fixed_vector(size_type capacity)
+{
+	assert(capacity > 0);
+
+	data_ = allocator_.allocate(capacity);
+	assert(data_);
+
+	capacity_ = capacity;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::fixed_vector(size_type capacity, const allocator_t& allocator)
+	: allocator_(allocator)
 {
 	assert(capacity > 0);
 
@@ -180,78 +469,170 @@ inline fixed_vector<T, allocator_t>::fixed_vector(size_type capacity)
 	capacity_ = capacity;
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::~fixed_vector() noexcept
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::~fixed_vector() noexcept
 {
 	release_();
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::fixed_vector(const fixed_vector& other)
-	: allocator_(other.allocator_)
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::fixed_vector(const fixed_vector& other)
+	: overflow_storage_t(other)
+	, allocator_(other.allocator_)
 	, data_(allocator_.allocate(other.capacity_))
 	, capacity_(other.capacity_)
 	, size_(other.size_)
 {
 	assert(data_);
-	std::uninitialized_copy_n(other.data_, other.size_, data_);
+	fv_detail::uninitialized_copy_n(other.data_, other.size_, data_);
+	observe_(container_event::push, size_);
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::fixed_vector(fixed_vector&& other) noexcept
-	: allocator_(std::move(other.allocator_))
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::fixed_vector(fixed_vector&& other) noexcept
+	: overflow_storage_t(std::move(other))
+	, allocator_(std::move(other.allocator_))
 	, data_(std::exchange(other.data_, nullptr))
 	, capacity_(std::exchange(other.capacity_, 0))
 	, size_(std::exchange(other.size_, 0))
 {
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>& fixed_vector<T, allocator_t>::operator=(const fixed_vector& other)
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>& fixed_vector<T, allocator_t, overflow_t>::operator=(const fixed_vector& other)
 {
 	return copy_or_move_assignment_(other, [](const fixed_vector& other, ptr_type dst){
-		std::uninitialized_copy_n(other.data_, other.size_, dst);
+		fv_detail::uninitialized_copy_n(other.data_, other.size_, dst);
 	});
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>& fixed_vector<T, allocator_t>::operator=(fixed_vector&& other) noexcept
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>& fixed_vector<T, allocator_t, overflow_t>::operator=(fixed_vector&& other) noexcept
 {
 	return  copy_or_move_assignment_(std::move(other), [](fixed_vector&& other, ptr_type dst){
-		std::uninitialized_move_n(other.data_, other.size_, dst);
+		fv_detail::uninitialized_relocate_n(other.data_, other.size_, dst);
 
-		other.data_ = nullptr;
-		other.capacity_ = 0;
 		other.size_ = 0;
+		other.release_();
 	});
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline void fixed_vector<T, allocator_t>::push_back(cref_type item)
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::push_back(cref_type item)
+{
+	emplace_back(item);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::push_back(rref_type item)
+{
+	emplace_back(std::move(item));
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline bool fixed_vector<T, allocator_t, overflow_t>::try_push_back(cref_type item)
+{
+	return try_emplace_back(item);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline bool fixed_vector<T, allocator_t, overflow_t>::try_push_back(rref_type item)
+{
+	return try_emplace_back(std::move(item));
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::insert_back(std::span<const value_type> items)
 {
 	assert(data_);
-	assert(size_ < capacity_);
+	assert(items.size() <= capacity_ - size_);
 
-	std::uninitialized_copy_n(&item, 1, data_+size_);
-	++size_;
+	const size_type count = static_cast<size_type>(items.size());
+	fv_detail::uninitialized_copy_n(items.data(), count, data_ + size_);
+	size_ += count;
+	observe_(container_event::push, count);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+template<std::ranges::input_range range_t>
+	requires std::ranges::sized_range<range_t> || std::ranges::forward_range<range_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::append_range(range_t&& range)
+{
+	if constexpr (std::ranges::contiguous_range<range_t> && std::same_as<std::ranges::range_value_t<range_t>, value_type>)
+	{
+		insert_back(std::span<const value_type>(std::ranges::data(range), std::ranges::size(range)));
+	}
+	else
+	{
+		assert(data_);
+
+		const auto count = static_cast<size_type>(std::ranges::distance(range));
+		assert(count <= capacity_ - size_);
+
+		std::uninitialized_copy_n(std::ranges::begin(range), count, data_ + size_);
+		size_ += count;
+		observe_(container_event::push, count);
+	}
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+template<std::forward_iterator iterator_t, std::sentinel_for<iterator_t> sentinel_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::assign(iterator_t first, sentinel_t last)
+{
+	clean();
+	append_range(std::ranges::subrange(std::move(first), std::move(last)));
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline void fixed_vector<T, allocator_t>::push_back(rref_type item)
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::push_back_n(size_type count, cref_type value)
 {
 	assert(data_);
-	assert(size_ < capacity_);
+	assert(count <= capacity_ - size_);
 
-	std::construct_at(&data_[size_], std::move(item));
-	++size_;
+	std::uninitialized_fill_n(data_ + size_, count, value);
+	size_ += count;
+	observe_(container_event::push, count);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline std::span<typename fixed_vector<T, allocator_t, overflow_t>::value_type> fixed_vector<T, allocator_t, overflow_t>::append_default_init(size_type count)
+{
+	assert(data_);
+	assert(count <= capacity_ - size_);
+
+	ptr_type first = data_ + size_;
+	std::uninitialized_default_construct_n(first, count);
+	size_ += count;
+	observe_(container_event::push, count);
+
+	return std::span<value_type>(first, count);
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline void fixed_vector<T, allocator_t>::release_()
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline std::span<typename fixed_vector<T, allocator_t, overflow_t>::value_type> fixed_vector<T, allocator_t, overflow_t>::resize_uninitialized(size_type new_size)
+{
+	assert(new_size <= capacity_);
+
+	if (new_size < size_)
+	{
+		const size_type count = size_ - new_size;
+		std::destroy(data_ + new_size, data_ + size_);
+		size_ = new_size;
+		observe_(container_event::remove, count);
+		return {};
+	}
+
+	return append_default_init(new_size - size_);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::release_()
 {
 	if (data_)
 	{
-		clean();
+		// not clean(): the block is going back to the allocator anyway, no point in discarding its pages
+		std::destroy_n(data_, size_);
+		size_ = 0;
 
 		allocator_.deallocate(data_, capacity_);
 		data_ = nullptr;
@@ -259,8 +640,8 @@ inline void fixed_vector<T, allocator_t>::release_()
 	}
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline void fixed_vector<T, allocator_t>::remove(size_type index)
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::remove(size_type index)
 {
 	assert(data_);
 	if (index != size_-1)
@@ -268,155 +649,442 @@ inline void fixed_vector<T, allocator_t>::remove(size_type index)
 
 	std::destroy_at(&data_[size_-1]);
 	--size_;
+	observe_(container_event::remove, 1);
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline void fixed_vector<T, allocator_t>::clean()
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::erase(size_type index)
 {
-	std::destroy_n(data_, size_);
-	size_ = 0;
+	assert(index < size_);
+	erase(index, index+1);
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::cref_type fixed_vector<T, allocator_t>::operator[](size_type index) const
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::erase(size_type first, size_type last)
 {
-	return data_[index];
+	assert(data_);
+	assert(first <= last && last <= size_);
+
+	const size_type count = last - first;
+	if (count == 0)
+		return;
+
+	if constexpr (is_trivially_relocatable_v<value_type>)
+	{
+		std::destroy(data_ + first, data_ + last);
+		std::memmove(static_cast<void*>(data_ + first), static_cast<const void*>(data_ + last), std::size_t(size_ - last) * sizeof(value_type));
+	}
+	else
+	{
+		std::move(data_ + last, data_ + size_, data_ + first);
+		std::destroy(data_ + size_ - count, data_ + size_);
+	}
+
+	size_ -= count;
+	observe_(container_event::remove, count);
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::ref_type fixed_vector<T, allocator_t>::operator[](size_type index)
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::erase_indices(std::span<const size_type> indices)
 {
-	return data_[index];
+	assert(std::ranges::adjacent_find(indices, std::greater_equal{}) == indices.end());
+	assert(indices.empty() || indices.back() < size_);
+
+	if (indices.empty())
+		return;
+
+	// every run of kept items between two holes is shifted left once, by the number of holes before it
+	size_type kept = indices.front();
+	for (std::size_t i = 0; i < indices.size(); ++i)
+	{
+		const size_type hole = indices[i];
+		const size_type next = i+1 < indices.size() ? indices[i+1] : size_;
+		const size_type run = next - hole - 1;
+
+		if constexpr (is_trivially_relocatable_v<value_type>)
+		{
+			std::destroy_at(&data_[hole]);
+			std::memmove(static_cast<void*>(data_ + kept), static_cast<const void*>(data_ + hole + 1), std::size_t(run) * sizeof(value_type));
+		}
+		else
+		{
+			std::move(data_ + hole + 1, data_ + next, data_ + kept);
+		}
+
+		kept += run;
+	}
+
+	if constexpr (!is_trivially_relocatable_v<value_type>)
+		std::destroy(data_ + kept, data_ + size_);
+
+	size_ = kept;
+	observe_(container_event::remove, static_cast<size_type>(indices.size()));
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::cref_type fixed_vector<T, allocator_t>::at(size_type index) const
+namespace fv_detail
 {
-	assert(index < size_);
-	return data_[index];
+
+template<class predicate_t, class value_type>
+struct is_simd_compare : std::false_type {};
+
+template<compare_op op, class value_type>
+struct is_simd_compare<compare_with<op, value_type>, value_type> : std::bool_constant<simd::simd_item<value_type>> {};
+
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::ref_type fixed_vector<T, allocator_t>::at(size_type index)
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+template<class predicate_t>
+inline fixed_vector<T, allocator_t, overflow_t>::size_type fixed_vector<T, allocator_t, overflow_t>::remove_if(predicate_t&& pred)
 {
-	assert(index < size_);
-	return data_[index];
+	const size_type old_size = size_;
+
+	if constexpr (fv_detail::is_simd_compare<std::remove_cvref_t<predicate_t>, value_type>::value)
+	{
+		[&]<compare_op op>(const compare_with<op, value_type>& compare) {
+			size_ = fv_detail::simd::compress<op>(data_, size_, compare.value);
+		}(pred);
+	}
+	else
+	{
+		size_type kept = 0;
+		while (kept < size_ && !pred(data_[kept]))
+			++kept;
+
+		for (size_type i = kept; i < size_; ++i)
+		{
+			if (!pred(data_[i]))
+			{
+				data_[kept] = std::move(data_[i]);
+				++kept;
+			}
+		}
+
+		std::destroy(data_ + kept, data_ + size_);
+		size_ = kept;
+	}
+
+	if (old_size != size_)
+		observe_(container_event::remove, old_size - size_);
+
+	return old_size - size_;
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::size_type fixed_vector<T, allocator_t>::size() const
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+template<class predicate_t>
+inline fixed_vector<T, allocator_t, overflow_t>::size_type fixed_vector<T, allocator_t, overflow_t>::remove_if_unordered(predicate_t&& pred)
 {
-	return size_;
+	const size_type old_size = size_;
+
+	size_type i = 0;
+	while (i < size_)
+	{
+		if (!pred(data_[i]))
+		{
+			++i;
+			continue;
+		}
+
+		// the moved-in last item is checked on the next iteration
+		if (i != size_-1)
+			data_[i] = std::move(data_[size_-1]);
+
+		std::destroy_at(&data_[size_-1]);
+		--size_;
+	}
+
+	if (old_size != size_)
+		observe_(container_event::remove, old_size - size_);
+
+	return old_size - size_;
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::size_type fixed_vector<T, allocator_t>::capacity() const
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::clean()
 {
-	return capacity_;
+	std::destroy_n(data_, size_);
+
+	if constexpr (discarding_allocator_concept<allocator_t, value_type>)
+	{
+		if (size_)
+			allocator_.discard(data_, size_);
+	}
+
+	const size_type count = size_;
+	size_ = 0;
+	observe_(container_event::clean, count);
+
+	if constexpr (std::same_as<overflow_t, overflow_spill>)
+		overflow_storage_t::spilled.clear();
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline bool fixed_vector<T, allocator_t>::full() const
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline void fixed_vector<T, allocator_t, overflow_t>::observe_(container_event event, size_type count)
 {
-	return size_ == capacity_;
+	if constexpr (observing_allocator_concept<allocator_t, value_type>)
+		allocator_.observe(event, count, size_, capacity_);
+	else
+		(void)event, (void)count;
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline bool fixed_vector<T, allocator_t>::empty() const
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::cref_type fixed_vector<T, allocator_t, overflow_t>::operator[](size_type index) const
 {
-	return size_ == 0;
+	return data_[index];
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::iterator fixed_vector<T, allocator_t>::begin()
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::ref_type fixed_vector<T, allocator_t, overflow_t>::operator[](size_type index)
 {
-	return data_;
+	return data_[index];
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::iterator fixed_vector<T, allocator_t>::end()
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::cref_type fixed_vector<T, allocator_t, overflow_t>::at(size_type index) const
 {
-	return data_ + size_;
+	assert(index < size_);
+	return data_[index];
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::ref_type fixed_vector<T, allocator_t, overflow_t>::at(size_type index)
+{
+	assert(index < size_);
+	return data_[index];
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::size_type fixed_vector<T, allocator_t, overflow_t>::size() const
+{
+	return size_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::size_type fixed_vector<T, allocator_t, overflow_t>::capacity() const
+{
+	return capacity_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline bool fixed_vector<T, allocator_t, overflow_t>::full() const
+{
+	return size_ == capacity_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline bool fixed_vector<T, allocator_t, overflow_t>::empty() const
+{
+	return size_ == 0;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline const allocator_t& fixed_vector<T, allocator_t, overflow_t>::get_allocator() const
+{
+	return allocator_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::const_iterator fixed_vector<T, allocator_t, overflow_t>::find(value_type value) const requires fv_detail::simd::simd_item<value_type>
+{
+	return fv_detail::simd::find<value_type>(data_, size_, value);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::iterator fixed_vector<T, allocator_t, overflow_t>::find(value_type value) requires fv_detail::simd::simd_item<value_type>
+{
+	return data_ + (fv_detail::simd::find<value_type>(data_, size_, value) - data_);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::size_type fixed_vector<T, allocator_t, overflow_t>::count(value_type value) const requires fv_detail::simd::simd_item<value_type>
+{
+	return fv_detail::simd::count<value_type>(data_, size_, value);
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::const_iterator fixed_vector<T, allocator_t>::cbegin() const
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline bool fixed_vector<T, allocator_t, overflow_t>::contains(value_type value) const requires fv_detail::simd::simd_item<value_type>
+{
+	return find(value) != end();
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::value_type fixed_vector<T, allocator_t, overflow_t>::min() const requires fv_detail::simd::simd_item<value_type>
+{
+	return minmax().first;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::value_type fixed_vector<T, allocator_t, overflow_t>::max() const requires fv_detail::simd::simd_item<value_type>
+{
+	return minmax().second;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline std::pair<typename fixed_vector<T, allocator_t, overflow_t>::value_type, typename fixed_vector<T, allocator_t, overflow_t>::value_type> fixed_vector<T, allocator_t, overflow_t>::minmax() const requires fv_detail::simd::simd_item<value_type>
+{
+	assert(size_ > 0);
+	return fv_detail::simd::minmax<value_type>(data_, size_);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fv_detail::simd::sum_type<typename fixed_vector<T, allocator_t, overflow_t>::value_type> fixed_vector<T, allocator_t, overflow_t>::sum() const requires fv_detail::simd::simd_item<value_type>
+{
+	return fv_detail::simd::sum<value_type>(data_, size_);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::iterator fixed_vector<T, allocator_t, overflow_t>::begin()
 {
 	return data_;
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::const_iterator fixed_vector<T, allocator_t>::cend() const
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::iterator fixed_vector<T, allocator_t, overflow_t>::end()
 {
 	return data_ + size_;
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::const_iterator fixed_vector<T, allocator_t>::begin() const
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::const_iterator fixed_vector<T, allocator_t, overflow_t>::cbegin() const
+{
+	return data_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::const_iterator fixed_vector<T, allocator_t, overflow_t>::cend() const
+{
+	return data_ + size_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::const_iterator fixed_vector<T, allocator_t, overflow_t>::begin() const
 {
 	return cbegin();
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::const_iterator fixed_vector<T, allocator_t>::end() const
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::const_iterator fixed_vector<T, allocator_t, overflow_t>::end() const
 {
 	return cend();
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::reverse_iterator fixed_vector<T, allocator_t>::rbegin()
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::reverse_iterator fixed_vector<T, allocator_t, overflow_t>::rbegin()
 {
 	return reverse_iterator(end());
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::reverse_iterator fixed_vector<T, allocator_t>::rend()
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::reverse_iterator fixed_vector<T, allocator_t, overflow_t>::rend()
 {
 	return reverse_iterator(begin());
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::const_reverse_iterator fixed_vector<T, allocator_t>::crbegin() const
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::const_reverse_iterator fixed_vector<T, allocator_t, overflow_t>::crbegin() const
 {
 	return rbegin();
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
-inline fixed_vector<T, allocator_t>::const_reverse_iterator fixed_vector<T, allocator_t>::crend() const
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline fixed_vector<T, allocator_t, overflow_t>::const_reverse_iterator fixed_vector<T, allocator_t, overflow_t>::crend() const
 {
 	return rend();
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
 template<class ...arg_type>
-inline void fixed_vector<T, allocator_t>::emplace_back(arg_type&& ...arg)
+inline void fixed_vector<T, allocator_t, overflow_t>::emplace_back(arg_type&& ...arg)
 {
 	assert(data_);
-	assert(size_ < capacity_);
+
+	if constexpr (std::same_as<overflow_t, overflow_assert>)
+	{
+		assert(size_ < capacity_);
+	}
+	else if (size_ == capacity_) [[unlikely]]
+	{
+		overflow_(std::forward<arg_type>(arg)...);
+		return;
+	}
+
 	std::construct_at(&data_[size_], std::forward<arg_type>(arg)...);
 	++size_;
+	observe_(container_event::push, 1);
 }
 
-template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+template<class ...arg_type>
+inline bool fixed_vector<T, allocator_t, overflow_t>::try_emplace_back(arg_type&& ...arg)
+{
+	assert(data_);
+
+	if (size_ == capacity_) [[unlikely]]
+		return false;
+
+	std::construct_at(&data_[size_], std::forward<arg_type>(arg)...);
+	++size_;
+	observe_(container_event::push, 1);
+	return true;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+template<class ...arg_type>
+inline void fixed_vector<T, allocator_t, overflow_t>::overflow_(arg_type&& ...arg)
+{
+	if constexpr (std::same_as<overflow_t, overflow_throw>)
+	{
+		throw std::length_error("fixed_vector is full");
+	}
+	else if constexpr (std::same_as<overflow_t, overflow_overwrite_oldest>)
+	{
+		// the new item is built first, arguments may refer to the item being erased
+		value_type item(std::forward<arg_type>(arg)...);
+		erase(0);
+		std::construct_at(&data_[size_], std::move(item));
+		++size_;
+		observe_(container_event::push, 1);
+	}
+	else if constexpr (std::same_as<overflow_t, overflow_spill>)
+	{
+		overflow_storage_t::spilled.emplace_back(std::forward<arg_type>(arg)...);
+	}
+	else
+	{
+		static_assert(std::same_as<overflow_t, overflow_drop_newest>);
+		((void)arg, ...);
+	}
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline std::span<typename fixed_vector<T, allocator_t, overflow_t>::value_type> fixed_vector<T, allocator_t, overflow_t>::spilled() requires std::same_as<overflow_t, overflow_spill>
+{
+	return overflow_storage_t::spilled;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
+inline std::span<const typename fixed_vector<T, allocator_t, overflow_t>::value_type> fixed_vector<T, allocator_t, overflow_t>::spilled() const requires std::same_as<overflow_t, overflow_spill>
+{
+	return overflow_storage_t::spilled;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> allocator_t, class overflow_t>
 template<class fv_t, class tranfsfer_fn>
-	requires std::same_as<std::remove_cvref_t<fv_t>, fixed_vector<T, allocator_t>>
-inline fixed_vector<T, allocator_t>& fixed_vector<T, allocator_t>::copy_or_move_assignment_(fv_t&& other, tranfsfer_fn&& transfer_strategy)
+	requires std::same_as<std::remove_cvref_t<fv_t>, fixed_vector<T, allocator_t, overflow_t>>
+inline fixed_vector<T, allocator_t, overflow_t>& fixed_vector<T, allocator_t, overflow_t>::copy_or_move_assignment_(fv_t&& other, tranfsfer_fn&& transfer_strategy)
 {
 	if (this == &other)
 		return *this;
 
-	if constexpr (std::is_rvalue_reference_v<decltype(other)>)
-		allocator_ = std::move(other.allocator_);
-	else
-		allocator_ = other.allocator_;
-
 	if (other.capacity_ > capacity_)
 	{
-		// check if we can allocate new memory block and only then destroy our data
-		new_data = allocator_.allocate(other.capacity_);
+		// check if we can allocate new memory block and only then destroy our data.
+		// Our block must be returned to the allocator it was taken from, so the other's allocator is adopted only after release
+		allocator_t new_allocator = other.allocator_;
+		ptr_type new_data = new_allocator.allocate(other.capacity_);
 		assert(new_data);
 
 		release_();
+		allocator_ = std::move(new_allocator);
 		data_ = new_data;
 
 		capacity_ = other.capacity_;
@@ -426,8 +1094,345 @@ inline fixed_vector<T, allocator_t>& fixed_vector<T, allocator_t>::copy_or_move_
 		clean();
 	}
 
-	size_ = other.size_;
+	// size is updated only after transfer, so a throwing copy leaves us empty instead of half-initialized
+	const size_type size = other.size_;
 	transfer_strategy(std::forward<fv_t>(other), data_);
+	size_ = size;
+	observe_(container_event::push, size_);
+
+	if constexpr (std::same_as<overflow_t, overflow_spill>)
+	{
+		if constexpr (std::is_rvalue_reference_v<fv_t&&>)
+			overflow_storage_t::spilled = std::move(other.spilled);
+		else
+			overflow_storage_t::spilled = other.spilled;
+	}
+
+	return *this;
+}
+
+/// <summary>
+/// Fixed-capacity vector with in-object storage. Capacity is known at compile time and no memory is ever allocated,
+/// so the vector may live on the stack or inside other structures.
+/// </summary>
+/// <typeparam name="T">Items type</typeparam>
+/// <typeparam name="N">Capacity</typeparam>
+template<class T, uint32_t N>
+class inline_fixed_vector
+{
+	static_assert(N > 0, "Capacity must be greater than zero");
+public:
+	using value_type = std::remove_cvref_t<T>;
+
+	using ref_type   = value_type&;
+	using cref_type  = value_type const&;
+	using rref_type  = value_type&&;
+
+	using ptr_type   = value_type*;
+	using cptr_type  = value_type const*;
+
+	using iterator = ptr_type;
+	using const_iterator = cptr_type;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	using size_type = uint32_t;
+
+	/// <summary>
+	/// Ctor
+	/// </summary>
+	inline_fixed_vector() noexcept = default;
+	~inline_fixed_vector() noexcept;
+
+	/// <summary>
+	/// Copy ctor
+	/// </summary>
+	inline_fixed_vector(const inline_fixed_vector& other);
+
+	/// <summary>
+	/// Move ctor. Items are relocated one by one (as a single block copy for trivially relocatable types), other vector becomes empty
+	/// </summary>
+	inline_fixed_vector(inline_fixed_vector&& other) noexcept(std::is_nothrow_move_constructible_v<value_type>);
+
+	/// <summary>
+	/// Copy assignment operator
+	/// </summary>
+	inline_fixed_vector& operator=(const inline_fixed_vector& other);
+
+	/// <summary>
+	/// Move assignment operator. Items are relocated one by one (as a single block copy for trivially relocatable types), other vector becomes empty
+	/// </summary>
+	inline_fixed_vector& operator=(inline_fixed_vector&& other) noexcept(std::is_nothrow_move_constructible_v<value_type>);
+
+	/// <summary>
+	/// Add item to the end (copying)
+	/// </summary>
+	void push_back(cref_type item);
+
+	/// <summary>
+	/// Add item to the end (moving)
+	/// </summary>
+	void push_back(rref_type item);
+
+	/// <summary>
+	/// Emplacing item to the end
+	/// </summary>
+	template<class... arg_type>
+	void emplace_back(arg_type&&... arg);
+
+	/// <summary>
+	/// Remove item. If index != size()-1, then item will be swapped with the last item and only then last item destroyed
+	/// </summary>
+	/// <param name="index"> - index of removing item</param>
+	void remove(size_type index);
+
+	/// <summary>
+	/// Destroy all items
+	/// </summary>
+	void clean();
+
+	cref_type operator[](size_type index) const;
+	ref_type  operator[](size_type index);
+
+	cref_type at(size_type index) const;
+	ref_type  at(size_type index);
+
+	size_type size() const;
+	static constexpr size_type capacity() { return N; }
+
+	bool full() const;
+	bool empty() const;
+
+	iterator begin();
+	iterator end();
+
+	const_iterator cbegin() const;
+	const_iterator cend() const;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	reverse_iterator rbegin();
+	reverse_iterator rend();
+
+	const_reverse_iterator crbegin() const;
+	const_reverse_iterator crend() const;
+
+private:
+	alignas(value_type) std::byte storage_[N * sizeof(value_type)];
+	size_type size_ = 0;
+
+	ptr_type data_();
+	cptr_type data_() const;
+};
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::~inline_fixed_vector() noexcept
+{
+	clean();
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::inline_fixed_vector(const inline_fixed_vector& other)
+	: size_(other.size_)
+{
+	fv_detail::uninitialized_copy_n(other.data_(), other.size_, data_());
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::inline_fixed_vector(inline_fixed_vector&& other) noexcept(std::is_nothrow_move_constructible_v<value_type>)
+	: size_(other.size_)
+{
+	fv_detail::uninitialized_relocate_n(other.data_(), other.size_, data_());
+	other.size_ = 0;
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>& inline_fixed_vector<T, N>::operator=(const inline_fixed_vector& other)
+{
+	if (this == &other)
+		return *this;
+
+	clean();
+	fv_detail::uninitialized_copy_n(other.data_(), other.size_, data_());
+	size_ = other.size_;
 
 	return *this;
 }
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>& inline_fixed_vector<T, N>::operator=(inline_fixed_vector&& other) noexcept(std::is_nothrow_move_constructible_v<value_type>)
+{
+	if (this == &other)
+		return *this;
+
+	clean();
+	fv_detail::uninitialized_relocate_n(other.data_(), other.size_, data_());
+	size_ = std::exchange(other.size_, 0);
+
+	return *this;
+}
+
+template<class T, uint32_t N>
+inline void inline_fixed_vector<T, N>::push_back(cref_type item)
+{
+	assert(size_ < N);
+
+	std::construct_at(data_() + size_, item);
+	++size_;
+}
+
+template<class T, uint32_t N>
+inline void inline_fixed_vector<T, N>::push_back(rref_type item)
+{
+	assert(size_ < N);
+
+	std::construct_at(data_() + size_, std::move(item));
+	++size_;
+}
+
+template<class T, uint32_t N>
+template<class ...arg_type>
+inline void inline_fixed_vector<T, N>::emplace_back(arg_type&& ...arg)
+{
+	assert(size_ < N);
+
+	std::construct_at(data_() + size_, std::forward<arg_type>(arg)...);
+	++size_;
+}
+
+template<class T, uint32_t N>
+inline void inline_fixed_vector<T, N>::remove(size_type index)
+{
+	assert(index < size_);
+
+	ptr_type data = data_();
+	if (index != size_-1)
+		std::swap(data[index], data[size_-1]);
+
+	std::destroy_at(&data[size_-1]);
+	--size_;
+}
+
+template<class T, uint32_t N>
+inline void inline_fixed_vector<T, N>::clean()
+{
+	std::destroy_n(data_(), size_);
+	size_ = 0;
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::cref_type inline_fixed_vector<T, N>::operator[](size_type index) const
+{
+	return data_()[index];
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::ref_type inline_fixed_vector<T, N>::operator[](size_type index)
+{
+	return data_()[index];
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::cref_type inline_fixed_vector<T, N>::at(size_type index) const
+{
+	assert(index < size_);
+	return data_()[index];
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::ref_type inline_fixed_vector<T, N>::at(size_type index)
+{
+	assert(index < size_);
+	return data_()[index];
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::size_type inline_fixed_vector<T, N>::size() const
+{
+	return size_;
+}
+
+template<class T, uint32_t N>
+inline bool inline_fixed_vector<T, N>::full() const
+{
+	return size_ == N;
+}
+
+template<class T, uint32_t N>
+inline bool inline_fixed_vector<T, N>::empty() const
+{
+	return size_ == 0;
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::iterator inline_fixed_vector<T, N>::begin()
+{
+	return data_();
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::iterator inline_fixed_vector<T, N>::end()
+{
+	return data_() + size_;
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::const_iterator inline_fixed_vector<T, N>::cbegin() const
+{
+	return data_();
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::const_iterator inline_fixed_vector<T, N>::cend() const
+{
+	return data_() + size_;
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::const_iterator inline_fixed_vector<T, N>::begin() const
+{
+	return cbegin();
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::const_iterator inline_fixed_vector<T, N>::end() const
+{
+	return cend();
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::reverse_iterator inline_fixed_vector<T, N>::rbegin()
+{
+	return reverse_iterator(end());
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::reverse_iterator inline_fixed_vector<T, N>::rend()
+{
+	return reverse_iterator(begin());
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::const_reverse_iterator inline_fixed_vector<T, N>::crbegin() const
+{
+	return const_reverse_iterator(cend());
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::const_reverse_iterator inline_fixed_vector<T, N>::crend() const
+{
+	return const_reverse_iterator(cbegin());
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::ptr_type inline_fixed_vector<T, N>::data_()
+{
+	return std::launder(reinterpret_cast<ptr_type>(storage_));
+}
+
+template<class T, uint32_t N>
+inline inline_fixed_vector<T, N>::cptr_type inline_fixed_vector<T, N>::data_() const
+{
+	return std::launder(reinterpret_cast<cptr_type>(storage_));
+}
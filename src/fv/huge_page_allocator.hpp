@@ -0,0 +1,73 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+#include "os_memory.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// What huge_page_allocator does with a freshly mapped block
+/// </summary>
+enum class huge_page_mode
+{
+	/// Pages are faulted in by the first write
+	lazy,
+	/// Every page is touched on allocation, so no push_back ever takes a page fault
+	prefault,
+	/// Pages are locked in physical memory (mlock/VirtualLock); if the lock limit is exceeded the block is prefaulted instead
+	lock,
+};
+
+/// <summary>
+/// Allocator backing blocks with 2 MiB pages to cut TLB misses on large vectors (Linux; other platforms use regular pages).
+/// Block size is rounded up to a multiple of the huge page size.
+/// </summary>
+/// <typeparam name="T">Items type</typeparam>
+/// <typeparam name="mode">What is done with a freshly mapped block</typeparam>
+template<class T, huge_page_mode mode = huge_page_mode::lazy>
+class huge_page_allocator
+{
+public:
+	using value_type = std::remove_cvref_t<T>;
+	using size_type = uint32_t;
+
+	huge_page_allocator() noexcept = default;
+	~huge_page_allocator() noexcept = default;
+	huge_page_allocator(const huge_page_allocator&) noexcept = default;
+	huge_page_allocator(huge_page_allocator&&) noexcept = default;
+	huge_page_allocator& operator=(const huge_page_allocator&) noexcept = default;
+	huge_page_allocator& operator=(huge_page_allocator&&) noexcept = default;
+
+	inline value_type* allocate(size_type size)
+	{
+		const std::size_t bytes = n_bytes_(size);
+		void* p = fv_detail::map_huge_memory(bytes);
+
+		if constexpr (mode == huge_page_mode::lock)
+		{
+			if (!fv_detail::lock_memory(p, bytes))
+				fv_detail::prefault_memory(p, bytes);
+		}
+		else if constexpr (mode == huge_page_mode::prefault)
+		{
+			fv_detail::prefault_memory(p, bytes);
+		}
+
+		return static_cast<value_type*>(p);
+	}
+
+	inline void deallocate(value_type* p, size_type size)
+	{
+		assert(p);
+		// munmap drops the lock as well
+		fv_detail::unmap_memory(p, n_bytes_(size));
+	}
+
+private:
+	static std::size_t n_bytes_(size_type size)
+	{
+		return fv_detail::align_up(std::size_t(size) * sizeof(value_type), fv_detail::huge_page_size);
+	}
+};
+static_assert(allocator_concept<huge_page_allocator<int>, int>);
@@ -0,0 +1,437 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+#include "os_memory.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace fv_detail
+{
+
+/// <summary>
+/// Beginning of a mapped_fixed_vector file. Items follow at data_offset
+/// </summary>
+struct mapped_header
+{
+	static constexpr uint64_t magic_value = 0x3130304345564646; // "FFVEC001"
+	static constexpr uint32_t current_version = 1;
+
+	uint64_t magic;
+	uint32_t version;
+	uint32_t item_size;
+	uint32_t item_alignment;
+	uint32_t data_offset;
+	uint32_t capacity;
+	uint32_t size;
+};
+
+}
+
+/// <summary>
+/// Fixed-capacity vector stored in a memory-mapped file: a small header (magic, version, item size, capacity, size)
+/// followed by the items. Appends write straight into the file, and a snapshot written once is reopened without parsing
+/// or copying, pages are read in by the OS on first access. The file uses the native byte order and layout of T.
+/// The size is published with a release store after the items, so another process mapping the file sees only written items.
+/// Pages reach the file in no particular order: after a crash the stored size may be ahead of the items unless flush() was called.
+/// </summary>
+/// <typeparam name="T">Items type, must be trivially copyable</typeparam>
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+class mapped_fixed_vector
+{
+public:
+	using value_type = std::remove_cvref_t<T>;
+
+	using ref_type   = value_type&;
+	using cref_type  = value_type const&;
+
+	using ptr_type   = value_type*;
+	using cptr_type  = value_type const*;
+
+	using iterator = ptr_type;
+	using const_iterator = cptr_type;
+
+	using size_type = uint32_t;
+
+	/// <summary>
+	/// Create an empty vector in a new file, an existing file is overwritten. Throws std::system_error on failure
+	/// </summary>
+	/// <param name="capacity"> - number of items the file has room for</param>
+	static mapped_fixed_vector create(const std::filesystem::path& path, size_type capacity);
+
+	/// <summary>
+	/// Map a file written by create(). A read-only vector is mapped copy-on-write: modified items stay private to it and never reach the file.
+	/// Throws std::system_error if the file can't be mapped and std::runtime_error if it was written for another item type
+	/// </summary>
+	static mapped_fixed_vector open(const std::filesystem::path& path, bool writable = false);
+
+	~mapped_fixed_vector() noexcept;
+
+	mapped_fixed_vector(const mapped_fixed_vector&) = delete;
+	mapped_fixed_vector& operator=(const mapped_fixed_vector&) = delete;
+
+	/// <summary>
+	/// Move ctor. Other vector is left unmapped
+	/// </summary>
+	mapped_fixed_vector(mapped_fixed_vector&& other) noexcept;
+	mapped_fixed_vector& operator=(mapped_fixed_vector&& other) noexcept;
+
+	/// <summary>
+	/// Add item to the end
+	/// </summary>
+	void push_back(cref_type item);
+
+	/// <summary>
+	/// Emplacing item to the end
+	/// </summary>
+	template<class... arg_type>
+	void emplace_back(arg_type&&... arg);
+
+	/// <summary>
+	/// Add copies of items to the end as a single block copy
+	/// </summary>
+	void insert_back(std::span<const value_type> items);
+
+	/// <summary>
+	/// Remove item. If index != size()-1, then the last item is copied into its place
+	/// </summary>
+	void remove(size_type index);
+
+	/// <summary>
+	/// Remove all items, the file keeps its size
+	/// </summary>
+	void clean();
+
+	/// <summary>
+	/// Write modified pages back to the file and wait for it. Without flush() the OS writes them back on its own schedule
+	/// </summary>
+	bool flush();
+
+	cref_type operator[](size_type index) const;
+	ref_type  operator[](size_type index);
+
+	cref_type at(size_type index) const;
+	ref_type  at(size_type index);
+
+	size_type size() const;
+	size_type capacity() const;
+
+	bool full() const;
+	bool empty() const;
+	bool writable() const;
+
+	iterator begin();
+	iterator end();
+
+	const_iterator cbegin() const;
+	const_iterator cend() const;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+private:
+	fv_detail::file_view view_ = {};
+	fv_detail::mapped_header* header_ = nullptr;
+	ptr_type data_ = nullptr;
+	bool writable_ = false;
+
+	mapped_fixed_vector(fv_detail::file_view view, bool writable);
+
+	static constexpr uint32_t data_offset_();
+	void release_() noexcept;
+
+	std::atomic_ref<uint32_t> size_ref_() const;
+};
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T> mapped_fixed_vector<T>::create(const std::filesystem::path& path, size_type capacity)
+{
+	assert(capacity > 0);
+
+	mapped_fixed_vector vec(fv_detail::map_file(path, data_offset_() + std::size_t(capacity) * sizeof(value_type), true), true);
+
+	*vec.header_ = {
+		.magic = fv_detail::mapped_header::magic_value,
+		.version = fv_detail::mapped_header::current_version,
+		.item_size = sizeof(value_type),
+		.item_alignment = alignof(value_type),
+		.data_offset = data_offset_(),
+		.capacity = capacity,
+		.size = 0,
+	};
+
+	return vec;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T> mapped_fixed_vector<T>::open(const std::filesystem::path& path, bool writable)
+{
+	mapped_fixed_vector vec(fv_detail::map_file(path, 0, writable), writable);
+
+	const fv_detail::mapped_header& header = *vec.header_;
+
+	if (vec.view_.bytes < sizeof(fv_detail::mapped_header) || header.magic != fv_detail::mapped_header::magic_value)
+		throw std::runtime_error("mapped_fixed_vector: not a fixed_vector file");
+	if (header.version != fv_detail::mapped_header::current_version)
+		throw std::runtime_error("mapped_fixed_vector: unsupported file version");
+	if (header.item_size != sizeof(value_type) || header.item_alignment != alignof(value_type) || header.data_offset != data_offset_())
+		throw std::runtime_error("mapped_fixed_vector: file was written for another item type");
+	if (header.size > header.capacity || vec.view_.bytes < data_offset_() + std::size_t(header.capacity) * sizeof(value_type))
+		throw std::runtime_error("mapped_fixed_vector: file is truncated");
+
+	return vec;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::mapped_fixed_vector(fv_detail::file_view view, bool writable)
+	: view_(view)
+	, header_(static_cast<fv_detail::mapped_header*>(view.data))
+	, data_(reinterpret_cast<ptr_type>(static_cast<std::byte*>(view.data) + data_offset_()))
+	, writable_(writable)
+{
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::~mapped_fixed_vector() noexcept
+{
+	release_();
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::mapped_fixed_vector(mapped_fixed_vector&& other) noexcept
+	: view_(std::exchange(other.view_, {}))
+	, header_(std::exchange(other.header_, nullptr))
+	, data_(std::exchange(other.data_, nullptr))
+	, writable_(std::exchange(other.writable_, false))
+{
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>& mapped_fixed_vector<T>::operator=(mapped_fixed_vector&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	release_();
+
+	view_ = std::exchange(other.view_, {});
+	header_ = std::exchange(other.header_, nullptr);
+	data_ = std::exchange(other.data_, nullptr);
+	writable_ = std::exchange(other.writable_, false);
+
+	return *this;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline void mapped_fixed_vector<T>::push_back(cref_type item)
+{
+	emplace_back(item);
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+template<class... arg_type>
+inline void mapped_fixed_vector<T>::emplace_back(arg_type&&... arg)
+{
+	assert(writable_);
+
+	const size_type size = size_ref_().load(std::memory_order_relaxed);
+	assert(size < header_->capacity);
+
+	std::construct_at(&data_[size], std::forward<arg_type>(arg)...);
+	size_ref_().store(size + 1, std::memory_order_release);
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline void mapped_fixed_vector<T>::insert_back(std::span<const value_type> items)
+{
+	assert(writable_);
+
+	const size_type size = size_ref_().load(std::memory_order_relaxed);
+	assert(items.size() <= header_->capacity - size);
+
+	const size_type count = static_cast<size_type>(items.size());
+	fv_detail::uninitialized_copy_n(items.data(), count, data_ + size);
+	size_ref_().store(size + count, std::memory_order_release);
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline void mapped_fixed_vector<T>::remove(size_type index)
+{
+	assert(writable_);
+
+	const size_type last = size_ref_().load(std::memory_order_relaxed) - 1;
+	assert(index <= last);
+
+	if (index != last)
+		data_[index] = data_[last];
+
+	size_ref_().store(last, std::memory_order_release);
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline void mapped_fixed_vector<T>::clean()
+{
+	assert(writable_);
+	size_ref_().store(0, std::memory_order_release);
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline bool mapped_fixed_vector<T>::flush()
+{
+	assert(header_);
+	return !writable_ || fv_detail::flush_file(view_);
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::cref_type mapped_fixed_vector<T>::operator[](size_type index) const
+{
+	return data_[index];
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::ref_type mapped_fixed_vector<T>::operator[](size_type index)
+{
+	return data_[index];
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::cref_type mapped_fixed_vector<T>::at(size_type index) const
+{
+	assert(index < size());
+	return data_[index];
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::ref_type mapped_fixed_vector<T>::at(size_type index)
+{
+	assert(index < size());
+	return data_[index];
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::size_type mapped_fixed_vector<T>::size() const
+{
+	return header_ ? size_ref_().load(std::memory_order_acquire) : 0;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::size_type mapped_fixed_vector<T>::capacity() const
+{
+	return header_ ? header_->capacity : 0;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline bool mapped_fixed_vector<T>::full() const
+{
+	return size() == capacity();
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline bool mapped_fixed_vector<T>::empty() const
+{
+	return size() == 0;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline bool mapped_fixed_vector<T>::writable() const
+{
+	return writable_;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::iterator mapped_fixed_vector<T>::begin()
+{
+	return data_;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::iterator mapped_fixed_vector<T>::end()
+{
+	return data_ + size();
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::const_iterator mapped_fixed_vector<T>::cbegin() const
+{
+	return data_;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::const_iterator mapped_fixed_vector<T>::cend() const
+{
+	return data_ + size();
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::const_iterator mapped_fixed_vector<T>::begin() const
+{
+	return cbegin();
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline mapped_fixed_vector<T>::const_iterator mapped_fixed_vector<T>::end() const
+{
+	return cend();
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+constexpr uint32_t mapped_fixed_vector<T>::data_offset_()
+{
+	// items start on a cache line, or further if they need more alignment
+	return static_cast<uint32_t>(fv_detail::align_up(sizeof(fv_detail::mapped_header), std::max<std::size_t>(64, alignof(value_type))));
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline void mapped_fixed_vector<T>::release_() noexcept
+{
+	if (view_.data)
+		fv_detail::unmap_file(view_);
+
+	view_ = {};
+	header_ = nullptr;
+	data_ = nullptr;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline std::atomic_ref<uint32_t> mapped_fixed_vector<T>::size_ref_() const
+{
+	static_assert(std::atomic_ref<uint32_t>::is_always_lock_free, "Size in a shared mapping must be lock-free");
+	return std::atomic_ref<uint32_t>(header_->size);
+}
@@ -0,0 +1,127 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+#include "os_memory.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Where numa_allocator places the pages of a block
+/// </summary>
+enum class numa_policy
+{
+	/// Every page lands on the node of the thread which touches it first, see first_touch()
+	first_touch,
+	/// Pages are spread round-robin over all online nodes
+	interleave,
+	/// All pages are placed on one node given to the allocator
+	bind,
+};
+
+/// <summary>
+/// Allocator controlling NUMA placement of the block with the mbind syscall (no libnuma needed).
+/// The block is mapped lazily, so the policy applies to every page when it is faulted in.
+/// Outside Linux the policy is ignored.
+/// </summary>
+/// <typeparam name="T">Items type</typeparam>
+/// <typeparam name="policy">Pages placement</typeparam>
+template<class T, numa_policy policy = numa_policy::first_touch>
+class numa_allocator
+{
+public:
+	using value_type = std::remove_cvref_t<T>;
+	using size_type = uint32_t;
+
+	numa_allocator() noexcept = default;
+	explicit numa_allocator(uint32_t node) noexcept requires (policy == numa_policy::bind) : node_(node) {}
+	~numa_allocator() noexcept = default;
+	numa_allocator(const numa_allocator&) noexcept = default;
+	numa_allocator(numa_allocator&&) noexcept = default;
+	numa_allocator& operator=(const numa_allocator&) noexcept = default;
+	numa_allocator& operator=(numa_allocator&&) noexcept = default;
+
+	inline value_type* allocate(size_type size)
+	{
+		const std::size_t bytes = n_bytes_(size);
+		void* p = fv_detail::map_lazy_memory(bytes);
+
+		if constexpr (policy == numa_policy::interleave)
+		{
+			fv_detail::numa_bind_memory(p, bytes, fv_detail::numa_mode::interleave, fv_detail::numa_online_nodes());
+		}
+		else if constexpr (policy == numa_policy::bind)
+		{
+			assert(node_ < 64);
+			fv_detail::numa_bind_memory(p, bytes, fv_detail::numa_mode::bind, uint64_t(1) << node_);
+		}
+
+		return static_cast<value_type*>(p);
+	}
+
+	inline void deallocate(value_type* p, size_type size)
+	{
+		assert(p);
+		fv_detail::unmap_memory(p, n_bytes_(size));
+	}
+
+	uint32_t node() const { return node_; }
+
+private:
+	uint32_t node_ = 0;
+
+	static constexpr std::size_t n_bytes_(size_type size) { return std::size_t(size) * sizeof(value_type); }
+};
+static_assert(allocator_concept<numa_allocator<int>, int>);
+
+/// <summary>
+/// Fault in the pages of one chunk of an empty vector's block. Called by the thread which will consume the chunk,
+/// it places the chunk on that thread's node. Chunks are the capacity split evenly, with boundaries rounded to pages
+/// </summary>
+/// <param name="vec"> - empty vector</param>
+/// <param name="chunk_index"> - chunk to touch</param>
+/// <param name="chunk_count"> - number of chunks the block is split into</param>
+template<class T, class allocator_t, class overflow_t>
+inline void first_touch(fixed_vector<T, allocator_t, overflow_t>& vec, uint32_t chunk_index, uint32_t chunk_count)
+{
+	assert(vec.empty());
+	assert(chunk_index < chunk_count);
+
+	const std::size_t page = fv_detail::page_size();
+	const std::size_t bytes = std::size_t(vec.capacity()) * sizeof(typename fixed_vector<T, allocator_t, overflow_t>::value_type);
+	const uintptr_t base = reinterpret_cast<uintptr_t>(vec.begin());
+
+	auto boundary = [&](uint32_t chunk) {
+		const uintptr_t end = base + bytes;
+		return std::min(end, fv_detail::align_up(base + bytes * chunk / chunk_count, page));
+	};
+
+	const uintptr_t first = chunk_index == 0 ? base : boundary(chunk_index);
+	const uintptr_t last = boundary(chunk_index + 1);
+
+	if (last > first)
+		fv_detail::prefault_memory(reinterpret_cast<void*>(first), last - first);
+}
+
+/// <summary>
+/// Fault in the block of an empty vector from thread_count threads, thread i touching chunk i.
+/// Placement matches the consumers only if they use the same split and run where these threads ran;
+/// otherwise call first_touch() from the consumer threads themselves
+/// </summary>
+template<class T, class allocator_t, class overflow_t>
+inline void parallel_first_touch(fixed_vector<T, allocator_t, overflow_t>& vec, uint32_t thread_count)
+{
+	assert(thread_count > 0);
+
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count);
+
+	for (uint32_t i = 0; i < thread_count; ++i)
+		threads.emplace_back([&vec, i, thread_count] { first_touch(vec, i, thread_count); });
+
+	for (std::thread& thread : threads)
+		thread.join();
+}
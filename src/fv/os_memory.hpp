@@ -0,0 +1,460 @@
+﻿#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <new>
+#include <string>
+#include <system_error>
+
+#if defined(_WIN32)
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <cerrno>
+#endif
+
+#if defined(__linux__)
+	#include <sys/syscall.h>
+	#include <cstdio>
+#endif
+
+namespace fv_detail
+{
+
+/// <summary>
+/// Size of a regular memory page
+/// </summary>
+inline std::size_t page_size() noexcept
+{
+#if defined(_WIN32)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwPageSize;
+#else
+	static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	return size;
+#endif
+}
+
+constexpr std::size_t align_up(std::size_t value, std::size_t alignment) noexcept
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+/// <summary>
+/// Map readable and writable pages without backing them up front. Physical pages are given by the OS on first touch.
+/// On Windows the whole range is committed at once: it is charged against the commit limit up front, while physical pages
+/// still come on first touch. Reserving only would need a commit on every append path.
+/// Throws std::bad_alloc on failure
+/// </summary>
+inline void* map_lazy_memory(std::size_t bytes)
+{
+	assert(bytes > 0);
+
+#if defined(_WIN32)
+	void* p = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (!p)
+		throw std::bad_alloc();
+#else
+	void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (p == MAP_FAILED)
+		throw std::bad_alloc();
+#endif
+
+	return p;
+}
+
+/// <summary>
+/// Unmap pages mapped by map_lazy_memory
+/// </summary>
+inline void unmap_memory(void* p, std::size_t bytes) noexcept
+{
+	assert(p);
+
+#if defined(_WIN32)
+	(void)bytes;
+	VirtualFree(p, 0, MEM_RELEASE);
+#else
+	munmap(p, bytes);
+#endif
+}
+
+/// <summary>
+/// Give physical pages of the range back to the OS, the range stays mapped. Contents of the range are lost.
+/// p must be page aligned
+/// </summary>
+inline void discard_memory(void* p, std::size_t bytes) noexcept
+{
+	assert(reinterpret_cast<uintptr_t>(p) % page_size() == 0);
+
+	bytes = align_up(bytes, page_size());
+
+#if defined(_WIN32)
+	VirtualAlloc(p, bytes, MEM_RESET, PAGE_READWRITE);
+#else
+	madvise(p, bytes, MADV_DONTNEED);
+#endif
+}
+
+/// <summary>
+/// Size of a huge (large) memory page on x86-64
+/// </summary>
+inline constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+/// <summary>
+/// Map memory backed by huge pages. Explicit huge pages (MAP_HUGETLB) are tried first, if none are reserved
+/// the block is aligned to a huge page boundary and marked for transparent huge pages instead.
+/// Other platforms fall back to map_lazy_memory. bytes must be a multiple of huge_page_size.
+/// Throws std::bad_alloc on failure, release with unmap_memory
+/// </summary>
+inline void* map_huge_memory(std::size_t bytes)
+{
+	assert(bytes > 0 && bytes % huge_page_size == 0);
+
+#if defined(__linux__)
+	void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (p != MAP_FAILED)
+		return p;
+
+	// over-map by one huge page and trim both ends, so the block starts on a huge page boundary
+	const std::size_t padded = bytes + huge_page_size;
+	void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (raw == MAP_FAILED)
+		throw std::bad_alloc();
+
+	std::byte* begin = static_cast<std::byte*>(raw);
+	std::byte* aligned = begin + (align_up(reinterpret_cast<uintptr_t>(begin), huge_page_size) - reinterpret_cast<uintptr_t>(begin));
+	std::byte* end = begin + padded;
+
+	if (aligned != begin)
+		munmap(begin, aligned - begin);
+	if (aligned + bytes != end)
+		munmap(aligned + bytes, end - (aligned + bytes));
+
+	madvise(aligned, bytes, MADV_HUGEPAGE);
+	return aligned;
+#else
+	return map_lazy_memory(bytes);
+#endif
+}
+
+/// <summary>
+/// Touch every page of the range, so later writes never take a page fault. Contents of the range are lost
+/// </summary>
+inline void prefault_memory(void* p, std::size_t bytes) noexcept
+{
+	volatile std::byte* begin = static_cast<std::byte*>(p);
+	const std::size_t step = page_size();
+
+	for (std::size_t offset = 0; offset < bytes; offset += step)
+		begin[offset] = std::byte{ 0 };
+}
+
+/// <summary>
+/// Pin pages of the range in physical memory, which also faults them in.
+/// Fails if the process is not allowed to lock that much memory
+/// </summary>
+inline bool lock_memory(void* p, std::size_t bytes) noexcept
+{
+#if defined(_WIN32)
+	return VirtualLock(p, bytes) != 0;
+#else
+	return mlock(p, bytes) == 0;
+#endif
+}
+
+/// <summary>
+/// NUMA memory policy modes of the mbind syscall (linux/mempolicy.h), spelled out to avoid the libnuma dependency
+/// </summary>
+enum class numa_mode : int
+{
+	default_policy = 0,
+	preferred = 1,
+	bind = 2,
+	interleave = 3,
+};
+
+/// <summary>
+/// Mask of online NUMA nodes (first 64 nodes). Node 0 only if the topology can't be read
+/// </summary>
+inline uint64_t numa_online_nodes() noexcept
+{
+	uint64_t mask = 0;
+
+#if defined(__linux__)
+	// list format: "0", "0-1", "0,2-3"
+	if (FILE* file = std::fopen("/sys/devices/system/node/online", "r"))
+	{
+		unsigned first = 0;
+		unsigned last = 0;
+		int matched = 0;
+
+		while ((matched = std::fscanf(file, "%u-%u", &first, &last)) >= 1)
+		{
+			if (matched == 1)
+				last = first;
+
+			for (unsigned node = first; node <= last && node < 64; ++node)
+				mask |= uint64_t(1) << node;
+
+			if (std::fgetc(file) != ',')
+				break;
+		}
+
+		std::fclose(file);
+	}
+#endif
+
+	return mask ? mask : 1;
+}
+
+/// <summary>
+/// Set NUMA policy of the range for pages not faulted in yet. Best effort: returns false if the policy could not be set,
+/// always false outside Linux
+/// </summary>
+inline bool numa_bind_memory(void* p, std::size_t bytes, numa_mode mode, uint64_t nodes) noexcept
+{
+#if defined(__linux__)
+	unsigned long mask = static_cast<unsigned long>(nodes);
+
+	// maxnode is one past the last bit the kernel reads, sizeof(mask) * 8 would drop node 63
+	return syscall(SYS_mbind, p, bytes, static_cast<int>(mode), &mask, sizeof(mask) * 8 + 1, 0) == 0;
+#else
+	(void)p; (void)bytes; (void)mode; (void)nodes;
+	return false;
+#endif
+}
+
+/// <summary>
+/// View of a file mapped into memory
+/// </summary>
+struct file_view
+{
+	void* data = nullptr;
+	std::size_t bytes = 0;
+};
+
+/// <summary>
+/// Map a file shared, so writes go to the file. With bytes > 0 the file is created if missing and resized to bytes,
+/// with bytes == 0 the whole existing file is mapped. A view which is not writable is mapped copy-on-write:
+/// its pages can still be written, the changes stay private to the view and never reach the file.
+/// Throws std::system_error on failure, release with unmap_file
+/// </summary>
+inline file_view map_file(const std::filesystem::path& path, std::size_t bytes, bool writable)
+{
+	assert(writable || bytes == 0);
+
+#if defined(_WIN32)
+	auto fail = [](const char* what) { throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), what); };
+
+	HANDLE file = CreateFileW(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		nullptr, bytes ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		fail("CreateFileW");
+
+	LARGE_INTEGER size = {};
+	if (bytes)
+	{
+		size.QuadPart = static_cast<LONGLONG>(bytes);
+		if (!SetFilePointerEx(file, size, nullptr, FILE_BEGIN) || !SetEndOfFile(file))
+		{
+			CloseHandle(file);
+			fail("SetEndOfFile");
+		}
+	}
+	else if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		fail("GetFileSizeEx");
+	}
+
+	// the view keeps the file open, handles are not needed after mapping
+	HANDLE mapping = CreateFileMappingW(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping)
+		fail("CreateFileMappingW");
+
+	void* p = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!p)
+		fail("MapViewOfFile");
+
+	return { p, static_cast<std::size_t>(size.QuadPart) };
+#else
+	auto fail = [](const char* what) { throw std::system_error(errno, std::generic_category(), what); };
+
+	const int fd = ::open(path.c_str(), writable ? O_RDWR | (bytes ? O_CREAT : 0) : O_RDONLY, 0644);
+	if (fd < 0)
+		fail("open");
+
+	if (bytes)
+	{
+		if (ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+		{
+			const int error = errno;
+			close(fd);
+			throw std::system_error(error, std::generic_category(), "ftruncate");
+		}
+	}
+	else
+	{
+		struct stat info = {};
+		if (fstat(fd, &info) != 0 || info.st_size == 0)
+		{
+			const int error = info.st_size == 0 ? EINVAL : errno;
+			close(fd);
+			throw std::system_error(error, std::generic_category(), "fstat");
+		}
+		bytes = static_cast<std::size_t>(info.st_size);
+	}
+
+	// the mapping keeps the file open, the descriptor is not needed after mmap
+	void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+	const int error = errno;
+	close(fd);
+	if (p == MAP_FAILED)
+		throw std::system_error(error, std::generic_category(), "mmap");
+
+	return { p, bytes };
+#endif
+}
+
+/// <summary>
+/// Write modified pages of a file view back to the file and wait for it
+/// </summary>
+inline bool flush_file(const file_view& view) noexcept
+{
+#if defined(_WIN32)
+	return FlushViewOfFile(view.data, view.bytes) != 0;
+#else
+	return msync(view.data, view.bytes, MS_SYNC) == 0;
+#endif
+}
+
+/// <summary>
+/// Unmap a view mapped by map_file. Modified pages are written back to the file by the OS later
+/// </summary>
+inline void unmap_file(const file_view& view) noexcept
+{
+	assert(view.data);
+
+#if defined(_WIN32)
+	UnmapViewOfFile(view.data);
+#else
+	munmap(view.data, view.bytes);
+#endif
+}
+
+/// <summary>
+/// Map a named shared memory segment, writes are seen by every process mapping it. With bytes > 0 a new segment is created,
+/// with bytes == 0 an existing one is mapped whole. An existing POSIX segment of the same name is unlinked first and never
+/// truncated, so processes which still map it keep their contents. A Windows segment lives while it is mapped, creating one
+/// which is still mapped fails with ERROR_ALREADY_EXISTS. Throws std::system_error on failure, release with unmap_file
+/// </summary>
+inline file_view map_shared_memory(const std::string& name, std::size_t bytes, bool writable)
+{
+	assert(writable || bytes == 0);
+
+#if defined(_WIN32)
+	auto fail = [](const char* what) { throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), what); };
+
+	const std::string object_name = "Local\\" + name;
+
+	HANDLE mapping = bytes
+		? CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, DWORD(uint64_t(bytes) >> 32), DWORD(bytes), object_name.c_str())
+		: OpenFileMappingA(writable ? FILE_MAP_WRITE : FILE_MAP_READ, FALSE, object_name.c_str());
+	if (!mapping)
+		fail(bytes ? "CreateFileMappingA" : "OpenFileMappingA");
+
+	// CreateFileMappingA opens a live segment of the same name instead of creating a new one
+	if (bytes && GetLastError() == ERROR_ALREADY_EXISTS)
+	{
+		CloseHandle(mapping);
+		throw std::system_error(ERROR_ALREADY_EXISTS, std::system_category(), "CreateFileMappingA");
+	}
+
+	// the view keeps the segment alive, the handle is not needed after mapping
+	void* p = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, bytes);
+	CloseHandle(mapping);
+	if (!p)
+		fail("MapViewOfFile");
+
+	if (!bytes)
+	{
+		MEMORY_BASIC_INFORMATION info = {};
+		VirtualQuery(p, &info, sizeof(info));
+		bytes = info.RegionSize;
+	}
+
+	return { p, bytes };
+#else
+	const std::string object_name = name.starts_with('/') ? name : '/' + name;
+
+	// truncating a live segment would zero it under its readers and fault their accesses past the new size,
+	// so the old one is unlinked and stays with the processes mapping it
+	if (bytes && shm_unlink(object_name.c_str()) != 0 && errno != ENOENT)
+		throw std::system_error(errno, std::generic_category(), "shm_unlink");
+
+	const int flags = writable ? O_RDWR | (bytes ? O_CREAT | O_EXCL : 0) : O_RDONLY;
+	const int fd = shm_open(object_name.c_str(), flags, 0600);
+	if (fd < 0)
+		throw std::system_error(errno, std::generic_category(), "shm_open");
+
+	if (bytes)
+	{
+		if (ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+		{
+			const int error = errno;
+			close(fd);
+			throw std::system_error(error, std::generic_category(), "ftruncate");
+		}
+	}
+	else
+	{
+		struct stat info = {};
+		if (fstat(fd, &info) != 0 || info.st_size == 0)
+		{
+			const int error = info.st_size == 0 ? EINVAL : errno;
+			close(fd);
+			throw std::system_error(error, std::generic_category(), "fstat");
+		}
+		bytes = static_cast<std::size_t>(info.st_size);
+	}
+
+	void* p = mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	const int error = errno;
+	close(fd);
+	if (p == MAP_FAILED)
+		throw std::system_error(error, std::generic_category(), "mmap");
+
+	return { p, bytes };
+#endif
+}
+
+/// <summary>
+/// Remove the name of a shared memory segment, mappings stay valid. On Windows segments go away with their last mapping,
+/// so this does nothing there
+/// </summary>
+inline bool unlink_shared_memory(const std::string& name) noexcept
+{
+#if defined(_WIN32)
+	(void)name;
+	return true;
+#else
+	const std::string object_name = name.starts_with('/') ? name : '/' + name;
+	return shm_unlink(object_name.c_str()) == 0;
+#endif
+}
+
+}
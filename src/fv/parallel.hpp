@@ -0,0 +1,434 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// Small work-stealing thread pool. run() splits the indices of a job evenly between the calling thread and the workers;
+/// every participant takes indices from the front of its own range and, once it is empty, steals the back half of another one.
+/// Jobs are executed one at a time, a job started from inside a job of the same pool runs on the calling thread
+/// </summary>
+class thread_pool
+{
+public:
+	/// <summary>
+	/// Ctor
+	/// </summary>
+	/// <param name="thread_count"> - number of threads running a job including the calling one, 0 for std::thread::hardware_concurrency()</param>
+	explicit thread_pool(uint32_t thread_count = 0);
+	~thread_pool() noexcept;
+
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	/// <summary>
+	/// Pool with a thread per core, started on first use
+	/// </summary>
+	static thread_pool& shared();
+
+	/// <summary>
+	/// Call fn(index) for every index in [0, count) and wait for all of them.
+	/// The first exception thrown by fn is rethrown once the remaining indices are done
+	/// </summary>
+	template<class fn_t>
+	void run(uint32_t count, fn_t&& fn);
+
+	uint32_t thread_count() const;
+
+private:
+	static constexpr std::size_t cache_line_size = 64;
+
+	/// <summary>
+	/// Indices not taken yet, packed as begin | end << 32 so both ends change with one CAS
+	/// </summary>
+	struct alignas(cache_line_size) range_slot
+	{
+		std::atomic<uint64_t> range = 0;
+	};
+
+	struct job
+	{
+		void (*invoke)(void* fn, uint32_t index) = nullptr;
+		void* fn = nullptr;
+
+		std::unique_ptr<range_slot[]> slots;
+
+		std::atomic_flag failed;
+		std::exception_ptr error;
+	};
+
+	std::vector<std::thread> workers_;
+
+	std::mutex run_mutex_;
+
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable done_;
+	job* job_ = nullptr;
+	uint64_t generation_ = 0;
+	uint32_t busy_ = 0;
+	bool stop_ = false;
+
+	static thread_pool*& current_();
+
+	static uint64_t pack_(uint32_t begin, uint32_t end);
+	static bool pop_(range_slot& slot, uint32_t& index);
+	static bool steal_(range_slot& victim, range_slot& own, uint32_t& index);
+
+	void worker_loop_(uint32_t participant);
+	void execute_(job& job, uint32_t participant);
+};
+
+inline thread_pool::thread_pool(uint32_t thread_count)
+{
+	if (thread_count == 0)
+		thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+	workers_.reserve(thread_count - 1);
+	for (uint32_t i = 1; i < thread_count; ++i)
+		workers_.emplace_back([this, i] { worker_loop_(i); });
+}
+
+inline thread_pool::~thread_pool() noexcept
+{
+	{
+		std::lock_guard lock(mutex_);
+		stop_ = true;
+	}
+	wake_.notify_all();
+
+	for (std::thread& worker : workers_)
+		worker.join();
+}
+
+inline thread_pool& thread_pool::shared()
+{
+	static thread_pool pool;
+	return pool;
+}
+
+template<class fn_t>
+inline void thread_pool::run(uint32_t count, fn_t&& fn)
+{
+	if (count == 0)
+		return;
+
+	if (workers_.empty() || count == 1 || current_() == this)
+	{
+		// same contract as the pooled path: every index runs, then the first exception is rethrown
+		std::exception_ptr error;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			try
+			{
+				fn(i);
+			}
+			catch (...)
+			{
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+
+		if (error)
+			std::rethrow_exception(error);
+		return;
+	}
+
+	std::lock_guard run_lock(run_mutex_);
+
+	const uint32_t participants = thread_count();
+
+	job job;
+	job.invoke = [](void* fn, uint32_t index) { (*static_cast<std::remove_reference_t<fn_t>*>(fn))(index); };
+	job.fn = const_cast<void*>(static_cast<const void*>(std::addressof(fn)));
+	job.slots = std::make_unique<range_slot[]>(participants);
+
+	for (uint32_t i = 0; i < participants; ++i)
+		job.slots[i].range.store(pack_(uint32_t(uint64_t(count) * i / participants), uint32_t(uint64_t(count) * (i + 1) / participants)), std::memory_order_relaxed);
+
+	{
+		std::lock_guard lock(mutex_);
+		job_ = &job;
+		++generation_;
+		busy_ = static_cast<uint32_t>(workers_.size());
+	}
+	wake_.notify_all();
+
+	execute_(job, 0);
+
+	{
+		std::unique_lock lock(mutex_);
+		done_.wait(lock, [this] { return busy_ == 0; });
+		job_ = nullptr;
+	}
+
+	if (job.error)
+		std::rethrow_exception(job.error);
+}
+
+inline uint32_t thread_pool::thread_count() const
+{
+	return static_cast<uint32_t>(workers_.size()) + 1;
+}
+
+inline thread_pool*& thread_pool::current_()
+{
+	thread_local thread_pool* current = nullptr;
+	return current;
+}
+
+inline uint64_t thread_pool::pack_(uint32_t begin, uint32_t end)
+{
+	return uint64_t(begin) | (uint64_t(end) << 32);
+}
+
+inline bool thread_pool::pop_(range_slot& slot, uint32_t& index)
+{
+	uint64_t range = slot.range.load(std::memory_order_acquire);
+	for (;;)
+	{
+		const uint32_t begin = uint32_t(range);
+		const uint32_t end = uint32_t(range >> 32);
+		if (begin >= end)
+			return false;
+
+		if (slot.range.compare_exchange_weak(range, pack_(begin + 1, end), std::memory_order_acq_rel))
+		{
+			index = begin;
+			return true;
+		}
+	}
+}
+
+inline bool thread_pool::steal_(range_slot& victim, range_slot& own, uint32_t& index)
+{
+	uint64_t range = victim.range.load(std::memory_order_acquire);
+	for (;;)
+	{
+		const uint32_t begin = uint32_t(range);
+		const uint32_t end = uint32_t(range >> 32);
+		if (begin >= end)
+			return false;
+
+		const uint32_t first = end - (end - begin + 1) / 2;
+		if (victim.range.compare_exchange_weak(range, pack_(begin, first), std::memory_order_acq_rel))
+		{
+			// own range is empty, so no thief competes for it until the stolen part is published
+			own.range.store(pack_(first + 1, end), std::memory_order_release);
+			index = first;
+			return true;
+		}
+	}
+}
+
+inline void thread_pool::worker_loop_(uint32_t participant)
+{
+	current_() = this;
+
+	uint64_t seen = 0;
+	for (;;)
+	{
+		job* job = nullptr;
+		{
+			std::unique_lock lock(mutex_);
+			wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+			if (stop_)
+				return;
+
+			seen = generation_;
+			job = job_;
+		}
+
+		execute_(*job, participant);
+
+		bool last = false;
+		{
+			std::lock_guard lock(mutex_);
+			last = --busy_ == 0;
+		}
+		if (last)
+			done_.notify_one();
+	}
+}
+
+inline void thread_pool::execute_(job& job, uint32_t participant)
+{
+	thread_pool* const previous = std::exchange(current_(), this);
+
+	const uint32_t participants = thread_count();
+	range_slot& own = job.slots[participant];
+
+	for (;;)
+	{
+		uint32_t index = 0;
+		bool found = pop_(own, index);
+
+		for (uint32_t i = 1; !found && i < participants; ++i)
+			found = steal_(job.slots[(participant + i) % participants], own, index);
+
+		if (!found)
+			break;
+
+		try
+		{
+			job.invoke(job.fn, index);
+		}
+		catch (...)
+		{
+			if (!job.failed.test_and_set())
+				job.error = std::current_exception();
+		}
+	}
+
+	current_() = previous;
+}
+
+namespace fv_detail
+{
+
+/// <summary>
+/// Default chunk size in bytes, large enough to hide scheduling costs and small enough to balance uneven work
+/// </summary>
+inline constexpr std::size_t parallel_grain_bytes = 64 * 1024;
+
+/// <summary>
+/// Split of [0, size) into chunks of grain items, rounded up to whole cache lines so chunks of a cache-aligned block
+/// never share a line. Boundaries depend only on size and grain, so reductions combine partial results in the same order on any machine
+/// </summary>
+template<class T>
+struct chunks
+{
+	uint32_t size;
+	uint32_t grain;
+
+	chunks(uint32_t size, uint32_t grain)
+		: size(size)
+	{
+		constexpr uint32_t line_items = 64 % sizeof(T) == 0 ? uint32_t(64 / sizeof(T)) : 1;
+
+		if (grain == 0)
+			grain = uint32_t(std::max<std::size_t>(1, parallel_grain_bytes / sizeof(T)));
+
+		this->grain = (grain + line_items - 1) / line_items * line_items;
+	}
+
+	uint32_t count() const { return uint32_t((uint64_t(size) + grain - 1) / grain); }
+	uint32_t begin(uint32_t chunk) const { return uint32_t(std::min<uint64_t>(uint64_t(chunk) * grain, size)); }
+	uint32_t end(uint32_t chunk) const { return uint32_t(std::min<uint64_t>(uint64_t(chunk + 1) * grain, size)); }
+};
+
+}
+
+/// <summary>
+/// Call fn(item) for every item, chunks of grain items are spread over the pool's threads
+/// </summary>
+/// <param name="grain"> - items per chunk, 0 for 64 KiB worth of items</param>
+template<class T, class allocator_t, class overflow_t, class fn_t>
+inline void parallel_for_each(fixed_vector<T, allocator_t, overflow_t>& vec, fn_t fn, uint32_t grain = 0, thread_pool& pool = thread_pool::shared())
+{
+	using value_type = typename fixed_vector<T, allocator_t, overflow_t>::value_type;
+
+	const fv_detail::chunks<value_type> chunks(vec.size(), grain);
+	value_type* const data = vec.begin();
+
+	pool.run(chunks.count(), [&](uint32_t chunk) {
+		for (uint32_t i = chunks.begin(chunk); i < chunks.end(chunk); ++i)
+			fn(data[i]);
+	});
+}
+
+/// <summary>
+/// Replace the items of dst with fn(item) for every item of src, computed in parallel.
+/// dst capacity must fit src, its items are default-initialized first and then assigned
+/// </summary>
+/// <param name="grain"> - items per chunk, 0 for 64 KiB worth of items</param>
+template<class T, class allocator_t, class overflow_t, class U, class dst_allocator_t, class dst_overflow_t, class fn_t>
+inline void parallel_transform(const fixed_vector<T, allocator_t, overflow_t>& src, fixed_vector<U, dst_allocator_t, dst_overflow_t>& dst, fn_t fn, uint32_t grain = 0, thread_pool& pool = thread_pool::shared())
+{
+	using value_type = typename fixed_vector<T, allocator_t, overflow_t>::value_type;
+
+	assert(src.size() <= dst.capacity());
+	assert(static_cast<const void*>(src.begin()) != static_cast<const void*>(dst.begin()));
+
+	dst.clean();
+	auto out = dst.resize_uninitialized(src.size());
+
+	const fv_detail::chunks<value_type> chunks(src.size(), grain);
+	const value_type* const data = src.begin();
+
+	pool.run(chunks.count(), [&](uint32_t chunk) {
+		for (uint32_t i = chunks.begin(chunk); i < chunks.end(chunk); ++i)
+			out[i] = fn(data[i]);
+	});
+}
+
+/// <summary>
+/// Fold items with op. Every chunk is folded from its first item on some thread, then init and the chunk results are folded
+/// in chunk order on the calling thread. op must be associative and accept any mix of result_t and item arguments.
+/// The order of operations depends only on size and grain, so floating point results are reproducible
+/// </summary>
+/// <param name="grain"> - items per chunk, 0 for 64 KiB worth of items</param>
+template<class T, class allocator_t, class overflow_t, class result_t, class op_t = std::plus<>>
+	requires std::default_initializable<result_t>
+inline result_t parallel_reduce(const fixed_vector<T, allocator_t, overflow_t>& vec, result_t init, op_t op = {}, uint32_t grain = 0, thread_pool& pool = thread_pool::shared())
+{
+	using value_type = typename fixed_vector<T, allocator_t, overflow_t>::value_type;
+
+	const fv_detail::chunks<value_type> chunks(vec.size(), grain);
+	const value_type* const data = vec.begin();
+
+	std::vector<result_t> partials(chunks.count());
+
+	pool.run(chunks.count(), [&](uint32_t chunk) {
+		const uint32_t end = chunks.end(chunk);
+
+		result_t partial = static_cast<result_t>(data[chunks.begin(chunk)]);
+		for (uint32_t i = chunks.begin(chunk) + 1; i < end; ++i)
+			partial = op(std::move(partial), data[i]);
+
+		partials[chunk] = std::move(partial);
+	});
+
+	for (result_t& partial : partials)
+		init = op(std::move(init), std::move(partial));
+
+	return init;
+}
+
+/// <summary>
+/// Number of items matching pred, counted in parallel
+/// </summary>
+/// <param name="grain"> - items per chunk, 0 for 64 KiB worth of items</param>
+template<class T, class allocator_t, class overflow_t, class predicate_t>
+inline typename fixed_vector<T, allocator_t, overflow_t>::size_type parallel_count_if(const fixed_vector<T, allocator_t, overflow_t>& vec, predicate_t pred, uint32_t grain = 0, thread_pool& pool = thread_pool::shared())
+{
+	using value_type = typename fixed_vector<T, allocator_t, overflow_t>::value_type;
+
+	const fv_detail::chunks<value_type> chunks(vec.size(), grain);
+	const value_type* const data = vec.begin();
+
+	std::atomic<uint32_t> total = 0;
+
+	pool.run(chunks.count(), [&](uint32_t chunk) {
+		uint32_t count = 0;
+		for (uint32_t i = chunks.begin(chunk); i < chunks.end(chunk); ++i)
+			count += pred(data[i]) ? 1 : 0;
+
+		total.fetch_add(count, std::memory_order_relaxed);
+	});
+
+	return total.load(std::memory_order_relaxed);
+}
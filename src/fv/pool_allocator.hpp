@@ -0,0 +1,302 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+/// <summary>
+/// Where pool_allocator keeps released blocks
+/// </summary>
+enum class pool_sharing
+{
+	/// Blocks are cached by the releasing thread only
+	thread_local_only,
+	/// Blocks that do not fit into the thread cache go to a lock-free process-wide tier shared by all threads
+	shared_fallback,
+};
+
+namespace fv_detail
+{
+
+/// <summary>
+/// Per-thread free lists of raw blocks, one list per block size.
+/// Released blocks are linked through their own first bytes, so caching needs no extra memory.
+/// </summary>
+class pool_thread_cache
+{
+public:
+	static constexpr uint32_t max_blocks_per_size = 64;
+
+	~pool_thread_cache() noexcept;
+
+	/// <summary>
+	/// Cache of the calling thread, nullptr if the thread is already being torn down
+	/// </summary>
+	static pool_thread_cache* instance() noexcept;
+
+	void* pop(std::size_t bytes) noexcept;
+	bool push(void* p, std::size_t bytes) noexcept;
+
+private:
+	struct node
+	{
+		node* next;
+	};
+
+	struct free_list
+	{
+		std::size_t bytes;
+		node* head;
+		uint32_t count;
+	};
+
+	// services use a handful of capacities, linear search beats hashing here
+	std::vector<free_list> lists_;
+
+	static inline thread_local bool destroyed_ = false;
+
+	free_list* find_(std::size_t bytes) noexcept;
+};
+
+inline pool_thread_cache::~pool_thread_cache() noexcept
+{
+	for (free_list& list : lists_)
+	{
+		while (list.head)
+			::operator delete(std::exchange(list.head, list.head->next));
+	}
+
+	destroyed_ = true;
+}
+
+inline pool_thread_cache* pool_thread_cache::instance() noexcept
+{
+	if (destroyed_)
+		return nullptr;
+
+	static thread_local pool_thread_cache cache;
+	return &cache;
+}
+
+inline void* pool_thread_cache::pop(std::size_t bytes) noexcept
+{
+	free_list* list = find_(bytes);
+	if (!list || !list->head)
+		return nullptr;
+
+	--list->count;
+	return std::exchange(list->head, list->head->next);
+}
+
+inline bool pool_thread_cache::push(void* p, std::size_t bytes) noexcept
+{
+	free_list* list = find_(bytes);
+	if (!list)
+	{
+		try
+		{
+			list = &lists_.emplace_back(free_list{ bytes, nullptr, 0 });
+		}
+		catch (...)
+		{
+			return false;
+		}
+	}
+
+	if (list->count == max_blocks_per_size)
+		return false;
+
+	list->head = ::new(p) node{ list->head };
+	++list->count;
+	return true;
+}
+
+inline pool_thread_cache::free_list* pool_thread_cache::find_(std::size_t bytes) noexcept
+{
+	for (free_list& list : lists_)
+	{
+		if (list.bytes == bytes)
+			return &list;
+	}
+	return nullptr;
+}
+
+/// <summary>
+/// Process-wide lock-free tier. Each block size owns a bucket of slots, a block is published by CAS into an empty slot
+/// and taken by exchanging the slot with nullptr, so there is no ABA problem and no locks.
+/// Buckets are claimed once and never released.
+/// </summary>
+class pool_shared_tier
+{
+public:
+	static constexpr uint32_t bucket_count = 32;
+	static constexpr uint32_t slots_per_bucket = 32;
+
+	~pool_shared_tier() noexcept;
+
+	static pool_shared_tier& instance() noexcept;
+
+	void* pop(std::size_t bytes) noexcept;
+	bool push(void* p, std::size_t bytes) noexcept;
+
+private:
+	struct bucket
+	{
+		std::atomic<std::size_t> bytes = 0;
+		std::atomic<void*> slots[slots_per_bucket] = {};
+	};
+
+	bucket buckets_[bucket_count];
+
+	bucket* find_(std::size_t bytes, bool claim) noexcept;
+};
+
+inline pool_shared_tier::~pool_shared_tier() noexcept
+{
+	for (bucket& b : buckets_)
+	{
+		for (std::atomic<void*>& slot : b.slots)
+		{
+			if (void* p = slot.exchange(nullptr))
+				::operator delete(p);
+		}
+	}
+}
+
+inline pool_shared_tier& pool_shared_tier::instance() noexcept
+{
+	static pool_shared_tier tier;
+	return tier;
+}
+
+inline void* pool_shared_tier::pop(std::size_t bytes) noexcept
+{
+	bucket* b = find_(bytes, false);
+	if (!b)
+		return nullptr;
+
+	for (std::atomic<void*>& slot : b->slots)
+	{
+		if (slot.load(std::memory_order_relaxed))
+		{
+			if (void* p = slot.exchange(nullptr, std::memory_order_acquire))
+				return p;
+		}
+	}
+	return nullptr;
+}
+
+inline bool pool_shared_tier::push(void* p, std::size_t bytes) noexcept
+{
+	bucket* b = find_(bytes, true);
+	if (!b)
+		return false;
+
+	for (std::atomic<void*>& slot : b->slots)
+	{
+		void* expected = nullptr;
+		if (!slot.load(std::memory_order_relaxed) && slot.compare_exchange_strong(expected, p, std::memory_order_release, std::memory_order_relaxed))
+			return true;
+	}
+	return false;
+}
+
+inline pool_shared_tier::bucket* pool_shared_tier::find_(std::size_t bytes, bool claim) noexcept
+{
+	const std::size_t start = (bytes / alignof(std::max_align_t)) % bucket_count;
+
+	for (uint32_t i = 0; i < bucket_count; ++i)
+	{
+		bucket& b = buckets_[(start + i) % bucket_count];
+
+		std::size_t current = b.bytes.load(std::memory_order_acquire);
+		if (current == bytes)
+			return &b;
+
+		if (current == 0)
+		{
+			if (!claim)
+				return nullptr;
+
+			if (b.bytes.compare_exchange_strong(current, bytes, std::memory_order_acq_rel) || current == bytes)
+				return &b;
+		}
+	}
+	return nullptr;
+}
+
+}
+
+/// <summary>
+/// Allocator recycling memory blocks of the same size. A block released by one vector is handed straight
+/// to the next vector of the same capacity instead of going back to the heap.
+/// Blocks are cached per thread; with pool_sharing::shared_fallback overflowing blocks go to a lock-free shared tier
+/// and threads with an empty cache take blocks from it.
+/// </summary>
+/// <typeparam name="T">Items type</typeparam>
+/// <typeparam name="sharing">Where released blocks are kept</typeparam>
+template<class T, pool_sharing sharing = pool_sharing::thread_local_only>
+class pool_allocator
+{
+public:
+	using value_type = std::remove_cvref_t<T>;
+	using size_type = uint32_t;
+
+	pool_allocator() noexcept = default;
+	~pool_allocator() noexcept = default;
+	pool_allocator(const pool_allocator&) noexcept = default;
+	pool_allocator(pool_allocator&&) noexcept = default;
+	pool_allocator& operator=(const pool_allocator&) noexcept = default;
+	pool_allocator& operator=(pool_allocator&&) noexcept = default;
+
+	inline value_type* allocate(size_type size)
+	{
+		const std::size_t bytes = n_bytes_(size);
+
+		void* p = nullptr;
+		if (fv_detail::pool_thread_cache* cache = fv_detail::pool_thread_cache::instance())
+			p = cache->pop(bytes);
+
+		if constexpr (sharing == pool_sharing::shared_fallback)
+		{
+			if (!p)
+				p = fv_detail::pool_shared_tier::instance().pop(bytes);
+		}
+
+		if (!p)
+			p = ::operator new(bytes);
+
+		return reinterpret_cast<value_type*>(p);
+	}
+
+	inline void deallocate(value_type* p, size_type size)
+	{
+		assert(p);
+		const std::size_t bytes = n_bytes_(size);
+
+		fv_detail::pool_thread_cache* cache = fv_detail::pool_thread_cache::instance();
+		if (cache && cache->push(p, bytes))
+			return;
+
+		if constexpr (sharing == pool_sharing::shared_fallback)
+		{
+			if (fv_detail::pool_shared_tier::instance().push(p, bytes))
+				return;
+		}
+
+		::operator delete(reinterpret_cast<void*>(p));
+	}
+
+private:
+	// every block must be able to hold the free list link
+	static constexpr std::size_t n_bytes_(size_type size)
+	{
+		return std::max<std::size_t>(std::size_t(size) * sizeof(value_type), sizeof(void*));
+	}
+};
+static_assert(allocator_concept<pool_allocator<int>, int>);
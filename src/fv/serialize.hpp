@@ -0,0 +1,492 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+/// <summary>
+/// Encoding of the items in serialize(). Everything but raw is for integral items only
+/// </summary>
+enum class column_codec : uint8_t
+{
+	/// <summary>
+	/// Items as they are in memory, native byte order
+	/// </summary>
+	raw = 0,
+
+	/// <summary>
+	/// LEB128 varint per item, signed items are zigzag encoded first
+	/// </summary>
+	varint = 1,
+
+	/// <summary>
+	/// Zigzag encoded difference to the previous item as LEB128 varint. Best for sorted or slowly changing items
+	/// </summary>
+	delta_varint = 2,
+
+	/// <summary>
+	/// Blocks of 128 items stored as the block minimum and the bit-packed offsets from it
+	/// </summary>
+	bit_packed = 3,
+
+	/// <summary>
+	/// Zigzag encoded differences to the previous item, bit-packed in blocks of 128
+	/// </summary>
+	delta_bit_packed = 4,
+};
+
+/// <summary>
+/// Receiver of serialized bytes: called with consecutive chunks of the output
+/// </summary>
+template<class sink_t>
+concept byte_sink = std::invocable<sink_t&, std::span<const std::byte>>;
+
+namespace fv_detail
+{
+
+inline constexpr uint32_t bit_packed_block = 128;
+
+/// <summary>
+/// Items every column_codec applies to, the others are written raw only
+/// </summary>
+template<class T>
+concept encodable_integral = std::integral<T> && !std::same_as<T, bool>;
+
+/// <summary>
+/// Collects output bytes into a small buffer and passes it to the sink when full
+/// </summary>
+template<byte_sink sink_t>
+class byte_writer
+{
+public:
+	explicit byte_writer(sink_t& sink) : sink_(sink) {}
+
+	byte_writer(const byte_writer&) = delete;
+	byte_writer& operator=(const byte_writer&) = delete;
+
+	void put(std::byte byte)
+	{
+		if (size_ == buffer_.size())
+			flush();
+		buffer_[size_++] = byte;
+	}
+
+	void put(const void* data, std::size_t bytes)
+	{
+		flush();
+		sink_(std::span<const std::byte>(static_cast<const std::byte*>(data), bytes));
+	}
+
+	void put_varint(uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			put(std::byte(uint8_t(value) | 0x80));
+			value >>= 7;
+		}
+		put(std::byte(value));
+	}
+
+	void flush()
+	{
+		if (size_)
+			sink_(std::span<const std::byte>(buffer_.data(), size_));
+		size_ = 0;
+	}
+
+private:
+	sink_t& sink_;
+	std::array<std::byte, 4096> buffer_;
+	std::size_t size_ = 0;
+};
+
+/// <summary>
+/// Bounds-checked reader over the input of deserialize(). Throws std::runtime_error on truncated or malformed input
+/// </summary>
+class byte_reader
+{
+public:
+	explicit byte_reader(std::span<const std::byte> bytes) : bytes_(bytes) {}
+
+	std::byte get()
+	{
+		if (offset_ == bytes_.size())
+			throw std::runtime_error("deserialize: unexpected end of input");
+		return bytes_[offset_++];
+	}
+
+	const std::byte* take(std::size_t bytes)
+	{
+		if (bytes > bytes_.size() - offset_)
+			throw std::runtime_error("deserialize: unexpected end of input");
+
+		const std::byte* p = bytes_.data() + offset_;
+		offset_ += bytes;
+		return p;
+	}
+
+	uint64_t get_varint()
+	{
+		uint64_t value = 0;
+		for (uint32_t shift = 0; shift < 64; shift += 7)
+		{
+			const uint8_t byte = uint8_t(get());
+			value |= uint64_t(byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+				return value;
+		}
+		throw std::runtime_error("deserialize: varint is too long");
+	}
+
+	std::size_t offset() const { return offset_; }
+
+private:
+	std::span<const std::byte> bytes_;
+	std::size_t offset_ = 0;
+};
+
+/// <summary>
+/// Writes values of up to 64 bits LSB first. Wide values are split, so the accumulator never holds more than 39 bits
+/// </summary>
+template<byte_sink sink_t>
+class bit_writer
+{
+public:
+	explicit bit_writer(byte_writer<sink_t>& out) : out_(out) {}
+
+	void put(uint64_t value, uint32_t width)
+	{
+		if (width > 32)
+		{
+			put_(uint32_t(value), 32);
+			put_(value >> 32, width - 32);
+		}
+		else
+		{
+			put_(value, width);
+		}
+	}
+
+	void flush()
+	{
+		if (bits_)
+			out_.put(std::byte(acc_));
+		acc_ = 0;
+		bits_ = 0;
+	}
+
+private:
+	byte_writer<sink_t>& out_;
+	uint64_t acc_ = 0;
+	uint32_t bits_ = 0;
+
+	void put_(uint64_t value, uint32_t width)
+	{
+		acc_ |= value << bits_;
+		bits_ += width;
+
+		for (; bits_ >= 8; bits_ -= 8, acc_ >>= 8)
+			out_.put(std::byte(acc_));
+	}
+};
+
+class bit_reader
+{
+public:
+	explicit bit_reader(const std::byte* data) : data_(data) {}
+
+	uint64_t get(uint32_t width)
+	{
+		if (width > 32)
+		{
+			const uint64_t low = get_(32);
+			return low | (get_(width - 32) << 32);
+		}
+		return get_(width);
+	}
+
+private:
+	const std::byte* data_;
+	uint64_t acc_ = 0;
+	uint32_t bits_ = 0;
+
+	uint64_t get_(uint32_t width)
+	{
+		for (; bits_ < width; bits_ += 8)
+			acc_ |= uint64_t(*data_++) << bits_;
+
+		const uint64_t value = width == 0 ? 0 : acc_ & (~uint64_t(0) >> (64 - width));
+		acc_ = width == 64 ? 0 : acc_ >> width;
+		bits_ -= width;
+		return value;
+	}
+};
+
+template<std::integral T>
+inline std::make_unsigned_t<T> zigzag_encode(T value)
+{
+	using U = std::make_unsigned_t<T>;
+	if constexpr (std::is_signed_v<T>)
+		return U(U(value) << 1) ^ U(value >> (sizeof(T) * 8 - 1));
+	else
+		return value;
+}
+
+template<std::integral T>
+inline T zigzag_decode(std::make_unsigned_t<T> value)
+{
+	using U = std::make_unsigned_t<T>;
+	if constexpr (std::is_signed_v<T>)
+		return T(U(value >> 1) ^ U(0 - U(value & 1)));
+	else
+		return value;
+}
+
+/// <summary>
+/// Item as the unsigned number the codec stores: zigzag encoded item or zigzag encoded difference to the previous one
+/// </summary>
+template<std::integral T, bool delta>
+inline std::make_unsigned_t<T> to_code(T item, T& prev)
+{
+	using U = std::make_unsigned_t<T>;
+	if constexpr (delta)
+	{
+		const U diff = U(U(item) - U(prev));
+		prev = item;
+		return zigzag_encode(std::make_signed_t<U>(diff));
+	}
+	else
+	{
+		return zigzag_encode(item);
+	}
+}
+
+template<std::integral T, bool delta>
+inline T from_code(std::make_unsigned_t<T> code, T& prev)
+{
+	using U = std::make_unsigned_t<T>;
+	if constexpr (delta)
+	{
+		prev = T(U(prev) + U(zigzag_decode<std::make_signed_t<U>>(code)));
+		return prev;
+	}
+	else
+	{
+		return zigzag_decode<T>(code);
+	}
+}
+
+template<std::integral T, bool delta, byte_sink sink_t>
+inline void encode_varint(const T* items, uint32_t size, byte_writer<sink_t>& out)
+{
+	T prev = 0;
+	for (uint32_t i = 0; i < size; ++i)
+		out.put_varint(to_code<T, delta>(items[i], prev));
+}
+
+template<std::integral T, bool delta>
+inline void decode_varint(T* items, uint32_t size, byte_reader& in)
+{
+	using U = std::make_unsigned_t<T>;
+
+	T prev = 0;
+	for (uint32_t i = 0; i < size; ++i)
+	{
+		const uint64_t code = in.get_varint();
+		if (code > std::numeric_limits<U>::max())
+			throw std::runtime_error("deserialize: value does not fit the item type");
+		items[i] = from_code<T, delta>(U(code), prev);
+	}
+}
+
+/// <summary>
+/// Every block: varint block minimum, one byte of bit width, then (code - minimum) of every item packed with that width
+/// </summary>
+template<std::integral T, bool delta, byte_sink sink_t>
+inline void encode_bit_packed(const T* items, uint32_t size, byte_writer<sink_t>& out)
+{
+	using U = std::make_unsigned_t<T>;
+
+	std::array<U, bit_packed_block> codes;
+	T prev = 0;
+
+	for (uint32_t first = 0; first < size; first += bit_packed_block)
+	{
+		const uint32_t count = std::min(bit_packed_block, size - first);
+		for (uint32_t i = 0; i < count; ++i)
+			codes[i] = to_code<T, delta>(items[first + i], prev);
+
+		const auto [min, max] = std::minmax_element(codes.begin(), codes.begin() + count);
+		const U base = *min;
+		const uint32_t width = uint32_t(std::bit_width(U(*max - base)));
+
+		out.put_varint(base);
+		out.put(std::byte(width));
+
+		bit_writer bits(out);
+		for (uint32_t i = 0; i < count; ++i)
+			bits.put(U(codes[i] - base), width);
+		bits.flush();
+	}
+}
+
+template<std::integral T, bool delta>
+inline void decode_bit_packed(T* items, uint32_t size, byte_reader& in)
+{
+	using U = std::make_unsigned_t<T>;
+
+	T prev = 0;
+
+	for (uint32_t first = 0; first < size; first += bit_packed_block)
+	{
+		const uint32_t count = std::min(bit_packed_block, size - first);
+
+		const uint64_t base = in.get_varint();
+		const uint32_t width = uint32_t(in.get());
+		if (base > std::numeric_limits<U>::max() || width > sizeof(U) * 8)
+			throw std::runtime_error("deserialize: value does not fit the item type");
+
+		bit_reader bits(in.take((std::size_t(count) * width + 7) / 8));
+		for (uint32_t i = 0; i < count; ++i)
+			items[first + i] = from_code<T, delta>(U(base + bits.get(width)), prev);
+	}
+}
+
+template<class T>
+inline void decode_items(T* items, uint32_t count, column_codec codec, byte_reader& in)
+{
+	if (codec == column_codec::raw)
+	{
+		const std::byte* const data = in.take(std::size_t(count) * sizeof(T));
+
+		// any other byte is not a valid bool object
+		if constexpr (std::is_same_v<T, bool>)
+		{
+			static_assert(sizeof(bool) == 1);
+			if (std::any_of(data, data + count, [](std::byte b) { return b > std::byte(1); }))
+				throw std::runtime_error("deserialize: invalid bool value");
+		}
+
+		std::memcpy(static_cast<void*>(items), data, std::size_t(count) * sizeof(T));
+		return;
+	}
+
+	if constexpr (encodable_integral<T>)
+	{
+		switch (codec)
+		{
+		case column_codec::varint: return decode_varint<T, false>(items, count, in);
+		case column_codec::delta_varint: return decode_varint<T, true>(items, count, in);
+		case column_codec::bit_packed: return decode_bit_packed<T, false>(items, count, in);
+		case column_codec::delta_bit_packed: return decode_bit_packed<T, true>(items, count, in);
+		default: break;
+		}
+	}
+
+	throw std::runtime_error("deserialize: unsupported codec");
+}
+
+}
+
+/// <summary>
+/// Write integral items to sink: varint item count, codec byte, varint item size, then the items encoded with codec.
+/// Throws std::invalid_argument for a value which is not a column_codec
+/// </summary>
+/// <param name="sink"> - called with consecutive chunks of the output</param>
+template<class T, class allocator_t, class overflow_t, byte_sink sink_t>
+	requires fv_detail::encodable_integral<typename fixed_vector<T, allocator_t, overflow_t>::value_type>
+inline void serialize(const fixed_vector<T, allocator_t, overflow_t>& vec, sink_t&& sink, column_codec codec = column_codec::raw)
+{
+	using value_type = typename fixed_vector<T, allocator_t, overflow_t>::value_type;
+
+	if (codec > column_codec::delta_bit_packed)
+		throw std::invalid_argument("serialize: unknown codec");
+
+	fv_detail::byte_writer<std::remove_reference_t<sink_t>> out(sink);
+
+	out.put_varint(vec.size());
+	out.put(std::byte(codec));
+	out.put_varint(sizeof(value_type));
+
+	switch (codec)
+	{
+	case column_codec::raw: out.put(vec.begin(), std::size_t(vec.size()) * sizeof(value_type)); break;
+	case column_codec::varint: fv_detail::encode_varint<value_type, false>(vec.begin(), vec.size(), out); break;
+	case column_codec::delta_varint: fv_detail::encode_varint<value_type, true>(vec.begin(), vec.size(), out); break;
+	case column_codec::bit_packed: fv_detail::encode_bit_packed<value_type, false>(vec.begin(), vec.size(), out); break;
+	case column_codec::delta_bit_packed: fv_detail::encode_bit_packed<value_type, true>(vec.begin(), vec.size(), out); break;
+	}
+
+	out.flush();
+}
+
+/// <summary>
+/// Write other trivially copyable items to sink as they are in memory, in the same format with the raw codec.
+/// The codecs are for integral items only, so there is no codec argument
+/// </summary>
+/// <param name="sink"> - called with consecutive chunks of the output</param>
+template<class T, class allocator_t, class overflow_t, byte_sink sink_t>
+	requires std::is_trivially_copyable_v<typename fixed_vector<T, allocator_t, overflow_t>::value_type>
+		&& (!fv_detail::encodable_integral<typename fixed_vector<T, allocator_t, overflow_t>::value_type>)
+inline void serialize(const fixed_vector<T, allocator_t, overflow_t>& vec, sink_t&& sink)
+{
+	using value_type = typename fixed_vector<T, allocator_t, overflow_t>::value_type;
+
+	fv_detail::byte_writer<std::remove_reference_t<sink_t>> out(sink);
+
+	out.put_varint(vec.size());
+	out.put(std::byte(column_codec::raw));
+	out.put_varint(sizeof(value_type));
+	out.put(vec.begin(), std::size_t(vec.size()) * sizeof(value_type));
+	out.flush();
+}
+
+/// <summary>
+/// Replace the items of vec with the ones written by serialize(). Items are decoded straight into the vector's buffer,
+/// bool items are checked to be 0 or 1. Throws std::length_error if they don't fit the capacity and std::runtime_error on malformed input, the vector is left empty then
+/// </summary>
+/// <returns>number of bytes consumed</returns>
+template<class T, class allocator_t, class overflow_t>
+	requires std::is_trivially_copyable_v<typename fixed_vector<T, allocator_t, overflow_t>::value_type>
+inline std::size_t deserialize(std::span<const std::byte> bytes, fixed_vector<T, allocator_t, overflow_t>& vec)
+{
+	using value_type = typename fixed_vector<T, allocator_t, overflow_t>::value_type;
+
+	vec.clean();
+
+	fv_detail::byte_reader in(bytes);
+
+	const uint64_t size = in.get_varint();
+	const column_codec codec = column_codec(in.get());
+	const uint64_t item_size = in.get_varint();
+
+	if (item_size != sizeof(value_type))
+		throw std::runtime_error("deserialize: items were written for another type");
+	if (size > vec.capacity())
+		throw std::length_error("deserialize: items do not fit the capacity");
+
+	const uint32_t count = uint32_t(size);
+	value_type* const items = vec.resize_uninitialized(count).data();
+
+	try
+	{
+		fv_detail::decode_items(items, count, codec, in);
+	}
+	catch (...)
+	{
+		vec.clean();
+		throw;
+	}
+
+	return in.offset();
+}
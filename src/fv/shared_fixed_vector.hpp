@@ -0,0 +1,372 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+#include "os_memory.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace fv_detail
+{
+
+/// <summary>
+/// Beginning of a shared_fixed_vector segment. Every process maps the segment at its own address,
+/// so items are located by data_offset from the header instead of a pointer
+/// </summary>
+struct shared_header
+{
+	static constexpr uint64_t magic_value = 0x3130304345565346; // "FSVEC001"
+	static constexpr uint32_t current_version = 1;
+
+	uint64_t magic;
+	uint32_t version;
+	uint32_t item_size;
+	uint32_t item_alignment;
+	uint32_t data_offset;
+	uint32_t capacity;
+
+	// written by the producer only, on its own cache line so readers polling it don't share a line with the header fields
+	alignas(64) std::atomic<uint32_t> size;
+};
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Shared size must be address-free");
+
+}
+
+/// <summary>
+/// Fixed-capacity vector in a named shared memory segment which several processes map at once.
+/// One writer appends items and publishes them with a release store of the size kept in the segment,
+/// any number of readers see the items [0, size()) without copies or locks.
+/// Items are never moved once published, so readers may keep pointers to them until clean() is called
+/// </summary>
+/// <typeparam name="T">Items type, must be trivially copyable</typeparam>
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+class shared_fixed_vector
+{
+public:
+	using value_type = std::remove_cvref_t<T>;
+
+	using cref_type  = value_type const&;
+	using cptr_type  = value_type const*;
+
+	using const_iterator = cptr_type;
+
+	using size_type = uint32_t;
+
+	/// <summary>
+	/// Create the segment and map it for writing. Throws std::system_error on failure.
+	/// To restart a writer on POSIX just create again: the old segment is unlinked, never truncated, readers which still map it
+	/// keep the old items and reopen the name to see the new segment. On Windows the segment lives while any process maps it,
+	/// so every reader must unmap the old one before create succeeds
+	/// </summary>
+	/// <param name="capacity"> - number of items the segment has room for</param>
+	static shared_fixed_vector create(const std::string& name, size_type capacity);
+
+	/// <summary>
+	/// Map an existing segment for reading. Throws std::system_error if it can't be mapped and std::runtime_error
+	/// if it was created for another item type
+	/// </summary>
+	static shared_fixed_vector open(const std::string& name);
+
+	/// <summary>
+	/// Remove the segment name, processes which mapped it keep their mapping
+	/// </summary>
+	static bool unlink(const std::string& name);
+
+	~shared_fixed_vector() noexcept;
+
+	shared_fixed_vector(const shared_fixed_vector&) = delete;
+	shared_fixed_vector& operator=(const shared_fixed_vector&) = delete;
+
+	/// <summary>
+	/// Move ctor. Other vector is left unmapped
+	/// </summary>
+	shared_fixed_vector(shared_fixed_vector&& other) noexcept;
+	shared_fixed_vector& operator=(shared_fixed_vector&& other) noexcept;
+
+	/// <summary>
+	/// Add item to the end and publish it. Writer only
+	/// </summary>
+	void push_back(cref_type item);
+
+	/// <summary>
+	/// Emplacing item to the end and publish it. Writer only
+	/// </summary>
+	template<class... arg_type>
+	void emplace_back(arg_type&&... arg);
+
+	/// <summary>
+	/// Add copies of items to the end as a single block copy and publish them at once. Writer only
+	/// </summary>
+	void insert_back(std::span<const value_type> items);
+
+	/// <summary>
+	/// Unpublish all items. Writer only. Readers must be done with the old items before new ones are appended
+	/// </summary>
+	void clean();
+
+	cref_type operator[](size_type index) const;
+	cref_type at(size_type index) const;
+
+	/// <summary>
+	/// Number of published items. Items below it are fully written and never change until clean()
+	/// </summary>
+	size_type size() const;
+	size_type capacity() const;
+
+	bool full() const;
+	bool empty() const;
+	bool writable() const;
+
+	/// <summary>
+	/// Published items at the moment of the call
+	/// </summary>
+	std::span<const value_type> items() const;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+private:
+	fv_detail::file_view view_ = {};
+	fv_detail::shared_header* header_ = nullptr;
+	value_type* data_ = nullptr;
+	bool writable_ = false;
+
+	shared_fixed_vector(fv_detail::file_view view, bool writable);
+
+	static constexpr uint32_t data_offset_();
+	void release_() noexcept;
+};
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline shared_fixed_vector<T> shared_fixed_vector<T>::create(const std::string& name, size_type capacity)
+{
+	assert(capacity > 0);
+
+	shared_fixed_vector vec(fv_detail::map_shared_memory(name, data_offset_() + std::size_t(capacity) * sizeof(value_type), true), true);
+
+	fv_detail::shared_header& header = *vec.header_;
+	header.version = fv_detail::shared_header::current_version;
+	header.item_size = sizeof(value_type);
+	header.item_alignment = alignof(value_type);
+	header.data_offset = data_offset_();
+	header.capacity = capacity;
+	header.size.store(0, std::memory_order_relaxed);
+
+	// magic goes last, readers opening the segment in the meantime reject it instead of seeing a partial header
+	std::atomic_ref(header.magic).store(fv_detail::shared_header::magic_value, std::memory_order_release);
+
+	return vec;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline shared_fixed_vector<T> shared_fixed_vector<T>::open(const std::string& name)
+{
+	shared_fixed_vector vec(fv_detail::map_shared_memory(name, 0, false), false);
+
+	const fv_detail::shared_header& header = *vec.header_;
+
+	if (vec.view_.bytes < sizeof(fv_detail::shared_header)
+		|| std::atomic_ref(const_cast<uint64_t&>(header.magic)).load(std::memory_order_acquire) != fv_detail::shared_header::magic_value)
+		throw std::runtime_error("shared_fixed_vector: segment is not initialized");
+	if (header.version != fv_detail::shared_header::current_version)
+		throw std::runtime_error("shared_fixed_vector: unsupported segment version");
+	if (header.item_size != sizeof(value_type) || header.item_alignment != alignof(value_type) || header.data_offset != data_offset_())
+		throw std::runtime_error("shared_fixed_vector: segment was created for another item type");
+	if (vec.view_.bytes < data_offset_() + std::size_t(header.capacity) * sizeof(value_type))
+		throw std::runtime_error("shared_fixed_vector: segment is truncated");
+
+	return vec;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline bool shared_fixed_vector<T>::unlink(const std::string& name)
+{
+	return fv_detail::unlink_shared_memory(name);
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline shared_fixed_vector<T>::shared_fixed_vector(fv_detail::file_view view, bool writable)
+	: view_(view)
+	, header_(static_cast<fv_detail::shared_header*>(view.data))
+	, data_(reinterpret_cast<value_type*>(static_cast<std::byte*>(view.data) + data_offset_()))
+	, writable_(writable)
+{
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline shared_fixed_vector<T>::~shared_fixed_vector() noexcept
+{
+	release_();
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline shared_fixed_vector<T>::shared_fixed_vector(shared_fixed_vector&& other) noexcept
+	: view_(std::exchange(other.view_, {}))
+	, header_(std::exchange(other.header_, nullptr))
+	, data_(std::exchange(other.data_, nullptr))
+	, writable_(std::exchange(other.writable_, false))
+{
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline shared_fixed_vector<T>& shared_fixed_vector<T>::operator=(shared_fixed_vector&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	release_();
+
+	view_ = std::exchange(other.view_, {});
+	header_ = std::exchange(other.header_, nullptr);
+	data_ = std::exchange(other.data_, nullptr);
+	writable_ = std::exchange(other.writable_, false);
+
+	return *this;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline void shared_fixed_vector<T>::push_back(cref_type item)
+{
+	emplace_back(item);
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+template<class... arg_type>
+inline void shared_fixed_vector<T>::emplace_back(arg_type&&... arg)
+{
+	assert(writable_);
+
+	const size_type size = header_->size.load(std::memory_order_relaxed);
+	assert(size < header_->capacity);
+
+	std::construct_at(&data_[size], std::forward<arg_type>(arg)...);
+	header_->size.store(size + 1, std::memory_order_release);
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline void shared_fixed_vector<T>::insert_back(std::span<const value_type> items)
+{
+	assert(writable_);
+
+	const size_type size = header_->size.load(std::memory_order_relaxed);
+	assert(items.size() <= header_->capacity - size);
+
+	const size_type count = static_cast<size_type>(items.size());
+	fv_detail::uninitialized_copy_n(items.data(), count, data_ + size);
+	header_->size.store(size + count, std::memory_order_release);
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline void shared_fixed_vector<T>::clean()
+{
+	assert(writable_);
+	header_->size.store(0, std::memory_order_release);
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline shared_fixed_vector<T>::cref_type shared_fixed_vector<T>::operator[](size_type index) const
+{
+	return data_[index];
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline shared_fixed_vector<T>::cref_type shared_fixed_vector<T>::at(size_type index) const
+{
+	assert(index < size());
+	return data_[index];
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline shared_fixed_vector<T>::size_type shared_fixed_vector<T>::size() const
+{
+	return header_ ? header_->size.load(std::memory_order_acquire) : 0;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline shared_fixed_vector<T>::size_type shared_fixed_vector<T>::capacity() const
+{
+	return header_ ? header_->capacity : 0;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline bool shared_fixed_vector<T>::full() const
+{
+	return size() == capacity();
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline bool shared_fixed_vector<T>::empty() const
+{
+	return size() == 0;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline bool shared_fixed_vector<T>::writable() const
+{
+	return writable_;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline std::span<const typename shared_fixed_vector<T>::value_type> shared_fixed_vector<T>::items() const
+{
+	return std::span<const value_type>(data_, size());
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline shared_fixed_vector<T>::const_iterator shared_fixed_vector<T>::begin() const
+{
+	return data_;
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline shared_fixed_vector<T>::const_iterator shared_fixed_vector<T>::end() const
+{
+	return data_ + size();
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+constexpr uint32_t shared_fixed_vector<T>::data_offset_()
+{
+	return static_cast<uint32_t>(fv_detail::align_up(sizeof(fv_detail::shared_header), std::max<std::size_t>(64, alignof(value_type))));
+}
+
+template<class T>
+	requires std::is_trivially_copyable_v<std::remove_cvref_t<T>>
+inline void shared_fixed_vector<T>::release_() noexcept
+{
+	if (view_.data)
+		fv_detail::unmap_file(view_);
+
+	view_ = {};
+	header_ = nullptr;
+	data_ = nullptr;
+}
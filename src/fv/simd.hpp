@@ -0,0 +1,925 @@
+﻿#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define FV_SIMD_X86 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+	#endif
+#else
+	#define FV_SIMD_X86 0
+#endif
+
+// GCC and Clang only emit AVX instructions inside functions targeting them, MSVC allows intrinsics anywhere
+#if FV_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+	#define FV_TARGET_AVX2 __attribute__((target("avx2")))
+	#define FV_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#else
+	#define FV_TARGET_AVX2
+	#define FV_TARGET_AVX512
+#endif
+
+/// <summary>
+/// Comparison of an item with a fixed value
+/// </summary>
+enum class compare_op
+{
+	equal,
+	not_equal,
+	less,
+	less_equal,
+	greater,
+	greater_equal,
+};
+
+/// <summary>
+/// Predicate "item op value". fixed_vector::remove_if evaluates it with SIMD compares for arithmetic items,
+/// any other predicate is called item by item
+/// </summary>
+template<compare_op op, class T>
+struct compare_with
+{
+	T value;
+
+	constexpr bool operator()(const T& item) const
+	{
+		if constexpr (op == compare_op::equal)
+			return item == value;
+		else if constexpr (op == compare_op::not_equal)
+			return item != value;
+		else if constexpr (op == compare_op::less)
+			return item < value;
+		else if constexpr (op == compare_op::less_equal)
+			return item <= value;
+		else if constexpr (op == compare_op::greater)
+			return item > value;
+		else
+			return item >= value;
+	}
+};
+
+/// Kernels for searching and reducing arithmetic items, selected at runtime by the instruction sets the CPU supports.
+/// Every kernel works on a raw [first, first+count) range, the scalar versions are the reference and the fallback
+namespace fv_detail::simd
+{
+
+template<class T>
+concept simd_item = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+/// <summary>
+/// Items the vector kernels handle: float, double and integers up to 64 bits. Other simd_item types,
+/// like long double, use the scalar kernels
+/// </summary>
+template<class T>
+concept vector_item = simd_item<T> && (std::is_same_v<T, float> || std::is_same_v<T, double> || (std::is_integral_v<T> && sizeof(T) <= 8));
+
+/// <summary>
+/// Type sum() accumulates in: 64-bit for integers, the item type itself for floating point
+/// </summary>
+template<class T>
+using sum_type = std::conditional_t<std::is_floating_point_v<T>, T, std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+enum class isa
+{
+	scalar,
+	avx2,
+	avx512,
+};
+
+/// <summary>
+/// Best instruction set supported by the CPU and the OS, detected once
+/// </summary>
+inline isa detect_isa() noexcept
+{
+#if FV_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+		return isa::avx512;
+	if (__builtin_cpu_supports("avx2"))
+		return isa::avx2;
+#elif FV_SIMD_X86
+	int info[4];
+	__cpuid(info, 1);
+
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx)
+		return isa::scalar;
+
+	const unsigned long long xcr0 = _xgetbv(0);
+	__cpuidex(info, 7, 0);
+
+	const bool avx2 = (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5));
+	const bool avx512 = (xcr0 & 0xe6) == 0xe6 && (info[1] & (1 << 16)) && (info[1] & (1 << 30));
+	if (avx512)
+		return isa::avx512;
+	if (avx2)
+		return isa::avx2;
+#endif
+	return isa::scalar;
+}
+
+inline isa cpu_isa() noexcept
+{
+	static const isa detected = detect_isa();
+	return detected;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Scalar kernels. Loops over raw pointers, which compilers vectorize for the baseline instruction set (SSE2, NEON)
+
+template<simd_item T>
+inline const T* find_scalar(const T* first, uint32_t count, T value)
+{
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (first[i] == value)
+			return first + i;
+	}
+	return first + count;
+}
+
+template<simd_item T>
+inline uint32_t count_scalar(const T* first, uint32_t count, T value)
+{
+	uint32_t result = 0;
+	for (uint32_t i = 0; i < count; ++i)
+		result += first[i] == value;
+	return result;
+}
+
+template<simd_item T>
+inline std::pair<T, T> minmax_scalar(const T* first, uint32_t count)
+{
+	T lo = first[0];
+	T hi = first[0];
+	for (uint32_t i = 1; i < count; ++i)
+	{
+		lo = first[i] < lo ? first[i] : lo;
+		hi = hi < first[i] ? first[i] : hi;
+	}
+	return { lo, hi };
+}
+
+template<simd_item T>
+inline sum_type<T> sum_scalar(const T* first, uint32_t count)
+{
+	sum_type<T> result = 0;
+	for (uint32_t i = 0; i < count; ++i)
+		result += static_cast<sum_type<T>>(first[i]);
+	return result;
+}
+
+/// <summary>
+/// Move items not matching pred to the front keeping their order, returns the number of kept items
+/// </summary>
+template<simd_item T, class predicate_t>
+inline uint32_t compress_scalar(T* first, uint32_t count, predicate_t pred)
+{
+	uint32_t kept = 0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		first[kept] = first[i];
+		kept += !pred(first[i]);
+	}
+	return kept;
+}
+
+#if FV_SIMD_X86
+
+// ---------------------------------------------------------------------------------------------------------------------
+// AVX2 kernels. Compare results are turned into byte masks, so one item takes sizeof(T) mask bits
+
+template<vector_item T>
+FV_TARGET_AVX2 inline auto avx2_load(const T* p)
+{
+	if constexpr (std::is_same_v<T, float>)
+		return _mm256_loadu_ps(p);
+	else if constexpr (std::is_same_v<T, double>)
+		return _mm256_loadu_pd(p);
+	else
+		return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+template<vector_item T>
+FV_TARGET_AVX2 inline auto avx2_set1(T value)
+{
+	if constexpr (std::is_same_v<T, float>)
+		return _mm256_set1_ps(value);
+	else if constexpr (std::is_same_v<T, double>)
+		return _mm256_set1_pd(value);
+	else if constexpr (sizeof(T) == 1)
+		return _mm256_set1_epi8(static_cast<char>(value));
+	else if constexpr (sizeof(T) == 2)
+		return _mm256_set1_epi16(static_cast<short>(value));
+	else if constexpr (sizeof(T) == 4)
+		return _mm256_set1_epi32(static_cast<int>(value));
+	else
+		return _mm256_set1_epi64x(static_cast<long long>(value));
+}
+
+template<vector_item T, class reg_t>
+FV_TARGET_AVX2 inline uint32_t avx2_eq_mask(reg_t a, reg_t b)
+{
+	if constexpr (std::is_same_v<T, float>)
+		return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_EQ_OQ))));
+	else if constexpr (std::is_same_v<T, double>)
+		return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_EQ_OQ))));
+	else if constexpr (sizeof(T) == 1)
+		return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+	else if constexpr (sizeof(T) == 2)
+		return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, b)));
+	else if constexpr (sizeof(T) == 4)
+		return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, b)));
+	else
+		return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(a, b)));
+}
+
+template<vector_item T>
+FV_TARGET_AVX2 inline const T* find_avx2(const T* first, uint32_t count, T value)
+{
+	constexpr uint32_t lanes = 32 / sizeof(T);
+
+	const auto needle = avx2_set1(value);
+
+	uint32_t i = 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		if (const uint32_t mask = avx2_eq_mask<T>(avx2_load(first + i), needle))
+			return first + i + std::countr_zero(mask) / sizeof(T);
+	}
+
+	return find_scalar(first + i, count - i, value);
+}
+
+template<vector_item T>
+FV_TARGET_AVX2 inline uint32_t count_avx2(const T* first, uint32_t count, T value)
+{
+	constexpr uint32_t lanes = 32 / sizeof(T);
+
+	const auto needle = avx2_set1(value);
+
+	// every matching lane sets sizeof(T) mask bits, dividing per block keeps the sum within count
+	uint32_t result = 0;
+	uint32_t i = 0;
+	for (; i + lanes <= count; i += lanes)
+		result += std::popcount(avx2_eq_mask<T>(avx2_load(first + i), needle)) / sizeof(T);
+
+	return result + count_scalar(first + i, count - i, value);
+}
+
+// 64-bit integers have no AVX2 min/max, they use the scalar kernel
+template<class T>
+inline constexpr bool avx2_has_minmax = std::is_floating_point_v<T> || sizeof(T) <= 4;
+
+template<vector_item T, class reg_t>
+FV_TARGET_AVX2 inline reg_t avx2_min(reg_t a, reg_t b)
+{
+	if constexpr (std::is_same_v<T, float>)
+		return _mm256_min_ps(a, b);
+	else if constexpr (std::is_same_v<T, double>)
+		return _mm256_min_pd(a, b);
+	else if constexpr (sizeof(T) == 1)
+		return std::is_signed_v<T> ? _mm256_min_epi8(a, b) : _mm256_min_epu8(a, b);
+	else if constexpr (sizeof(T) == 2)
+		return std::is_signed_v<T> ? _mm256_min_epi16(a, b) : _mm256_min_epu16(a, b);
+	else
+		return std::is_signed_v<T> ? _mm256_min_epi32(a, b) : _mm256_min_epu32(a, b);
+}
+
+template<vector_item T, class reg_t>
+FV_TARGET_AVX2 inline reg_t avx2_max(reg_t a, reg_t b)
+{
+	if constexpr (std::is_same_v<T, float>)
+		return _mm256_max_ps(a, b);
+	else if constexpr (std::is_same_v<T, double>)
+		return _mm256_max_pd(a, b);
+	else if constexpr (sizeof(T) == 1)
+		return std::is_signed_v<T> ? _mm256_max_epi8(a, b) : _mm256_max_epu8(a, b);
+	else if constexpr (sizeof(T) == 2)
+		return std::is_signed_v<T> ? _mm256_max_epi16(a, b) : _mm256_max_epu16(a, b);
+	else
+		return std::is_signed_v<T> ? _mm256_max_epi32(a, b) : _mm256_max_epu32(a, b);
+}
+
+template<vector_item T, class reg_t>
+FV_TARGET_AVX2 inline void avx2_store(T* p, reg_t a)
+{
+	if constexpr (std::is_same_v<T, float>)
+		_mm256_storeu_ps(p, a);
+	else if constexpr (std::is_same_v<T, double>)
+		_mm256_storeu_pd(p, a);
+	else
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a);
+}
+
+template<vector_item T>
+FV_TARGET_AVX2 inline std::pair<T, T> minmax_avx2(const T* first, uint32_t count)
+{
+	constexpr uint32_t lanes = 32 / sizeof(T);
+
+	if (count < lanes)
+		return minmax_scalar(first, count);
+
+	auto lo = avx2_load(first);
+	auto hi = lo;
+
+	uint32_t i = lanes;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const auto items = avx2_load(first + i);
+		lo = avx2_min<T>(lo, items);
+		hi = avx2_max<T>(hi, items);
+	}
+
+	// the last partial block overlaps already seen items, which doesn't change min and max
+	if (i < count)
+	{
+		const auto items = avx2_load(first + count - lanes);
+		lo = avx2_min<T>(lo, items);
+		hi = avx2_max<T>(hi, items);
+	}
+
+	T lo_lanes[lanes];
+	T hi_lanes[lanes];
+	avx2_store(lo_lanes, lo);
+	avx2_store(hi_lanes, hi);
+
+	return { minmax_scalar(lo_lanes, lanes).first, minmax_scalar(hi_lanes, lanes).second };
+}
+
+// 8 and 16-bit integers would need several widening steps, they use the scalar kernel
+template<class T>
+inline constexpr bool simd_has_sum = std::is_floating_point_v<T> || sizeof(T) >= 4;
+
+template<vector_item T>
+FV_TARGET_AVX2 inline sum_type<T> sum_avx2(const T* first, uint32_t count)
+{
+	uint32_t i = 0;
+	sum_type<T> result = 0;
+
+	if constexpr (std::is_same_v<T, float>)
+	{
+		__m256 acc = _mm256_setzero_ps();
+		for (; i + 8 <= count; i += 8)
+			acc = _mm256_add_ps(acc, _mm256_loadu_ps(first + i));
+
+		float lanes[8];
+		_mm256_storeu_ps(lanes, acc);
+		result = sum_scalar(lanes, 8);
+	}
+	else if constexpr (std::is_same_v<T, double>)
+	{
+		__m256d acc = _mm256_setzero_pd();
+		for (; i + 4 <= count; i += 4)
+			acc = _mm256_add_pd(acc, _mm256_loadu_pd(first + i));
+
+		double lanes[4];
+		_mm256_storeu_pd(lanes, acc);
+		result = sum_scalar(lanes, 4);
+	}
+	else
+	{
+		// 32-bit items are widened to 64 bits, integer sums are exact modulo 2^64 in any order
+		__m256i acc = _mm256_setzero_si256();
+		if constexpr (sizeof(T) == 4)
+		{
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128i items = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+				acc = _mm256_add_epi64(acc, std::is_signed_v<T> ? _mm256_cvtepi32_epi64(items) : _mm256_cvtepu32_epi64(items));
+			}
+		}
+		else
+		{
+			for (; i + 4 <= count; i += 4)
+				acc = _mm256_add_epi64(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i)));
+		}
+
+		sum_type<T> lanes[4];
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+		result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+
+	return result + sum_scalar(first + i, count - i);
+}
+
+// Compress permutation tables: for every mask of kept lanes, 32-bit lane indices moving the kept lanes to the front.
+// 64-bit items take two 32-bit lanes each
+struct compress_tables
+{
+	alignas(64) uint8_t lanes32[256][8];
+	alignas(64) uint8_t lanes64[16][8];
+
+	constexpr compress_tables() : lanes32{}, lanes64{}
+	{
+		for (uint32_t mask = 0; mask < 256; ++mask)
+		{
+			uint32_t n = 0;
+			for (uint8_t lane = 0; lane < 8; ++lane)
+			{
+				if (mask & (1u << lane))
+					lanes32[mask][n++] = lane;
+			}
+		}
+
+		for (uint32_t mask = 0; mask < 16; ++mask)
+		{
+			uint32_t n = 0;
+			for (uint8_t lane = 0; lane < 4; ++lane)
+			{
+				if (mask & (1u << lane))
+				{
+					lanes64[mask][n++] = uint8_t(lane * 2);
+					lanes64[mask][n++] = uint8_t(lane * 2 + 1);
+				}
+			}
+		}
+	}
+};
+
+inline constexpr compress_tables compress_table;
+
+// Lanes of items matching "item op value", one bit per 32 or 64-bit item
+template<compare_op op, vector_item T, class reg_t>
+FV_TARGET_AVX2 inline uint32_t avx2_compare_mask(reg_t items, reg_t value)
+{
+	if constexpr (std::is_floating_point_v<T>)
+	{
+		constexpr int predicate =
+			op == compare_op::equal ? _CMP_EQ_OQ :
+			op == compare_op::not_equal ? _CMP_NEQ_UQ :
+			op == compare_op::less ? _CMP_LT_OQ :
+			op == compare_op::less_equal ? _CMP_LE_OQ :
+			op == compare_op::greater ? _CMP_GT_OQ : _CMP_GE_OQ;
+
+		if constexpr (std::is_same_v<T, float>)
+			return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(items, value, predicate)));
+		else
+			return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(items, value, predicate)));
+	}
+	else
+	{
+		// unsigned items are compared as signed after flipping the sign bit
+		if constexpr (std::is_unsigned_v<T>)
+		{
+			const __m256i sign = sizeof(T) == 4 ? _mm256_set1_epi32(INT32_MIN) : _mm256_set1_epi64x(INT64_MIN);
+			items = _mm256_xor_si256(items, sign);
+			value = _mm256_xor_si256(value, sign);
+		}
+
+		// every op is eq or gt, possibly with swapped operands and inverted result
+		constexpr bool invert = op == compare_op::not_equal || op == compare_op::greater_equal || op == compare_op::less_equal;
+
+		__m256i match;
+		if constexpr (op == compare_op::equal || op == compare_op::not_equal)
+			match = sizeof(T) == 4 ? _mm256_cmpeq_epi32(items, value) : _mm256_cmpeq_epi64(items, value);
+		else if constexpr (op == compare_op::less || op == compare_op::greater_equal)
+			match = sizeof(T) == 4 ? _mm256_cmpgt_epi32(value, items) : _mm256_cmpgt_epi64(value, items);
+		else
+			match = sizeof(T) == 4 ? _mm256_cmpgt_epi32(items, value) : _mm256_cmpgt_epi64(items, value);
+
+		const uint32_t mask = sizeof(T) == 4
+			? static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(match)))
+			: static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(match)));
+
+		return invert ? mask ^ (sizeof(T) == 4 ? 0xffu : 0xfu) : mask;
+	}
+}
+
+// 8 and 16-bit items have no cheap AVX2 compress, they use the scalar kernel
+template<class T>
+inline constexpr bool simd_has_compress = vector_item<T> && sizeof(T) >= 4;
+
+template<compare_op op, vector_item T>
+FV_TARGET_AVX2 inline uint32_t compress_avx2(T* first, uint32_t count, T value)
+{
+	constexpr uint32_t lanes = 32 / sizeof(T);
+	constexpr uint32_t all = (1u << lanes) - 1;
+
+	const auto needle = avx2_set1(value);
+
+	// kept items are written at or before the block being read, so compressing in place is safe
+	uint32_t kept = 0;
+	uint32_t i = 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const auto items = avx2_load(first + i);
+		const uint32_t keep = ~avx2_compare_mask<op, T>(items, needle) & all;
+
+		const uint8_t* lanes_of = sizeof(T) == 4 ? compress_table.lanes32[keep] : compress_table.lanes64[keep];
+		const __m256i permutation = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(lanes_of)));
+
+		if constexpr (std::is_same_v<T, float>)
+			_mm256_storeu_ps(first + kept, _mm256_permutevar8x32_ps(items, permutation));
+		else if constexpr (std::is_same_v<T, double>)
+			_mm256_storeu_pd(first + kept, _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(items), permutation)));
+		else
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(first + kept), _mm256_permutevar8x32_epi32(items, permutation));
+
+		kept += std::popcount(keep);
+	}
+
+	for (; i < count; ++i)
+	{
+		first[kept] = first[i];
+		kept += !compare_with<op, T>{ value }(first[i]);
+	}
+
+	return kept;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// AVX-512 kernels. Compares produce one mask bit per item
+
+// GCC 12 reports '__Y' may be used uninitialized from inside avx512fintrin.h: the masked intrinsics start from
+// _mm512_undefined_*(), which is self-initialized on purpose (GCC bug 105593), so the warning is a known false positive
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+template<vector_item T>
+FV_TARGET_AVX512 inline auto avx512_load(const T* p)
+{
+	if constexpr (std::is_same_v<T, float>)
+		return _mm512_loadu_ps(p);
+	else if constexpr (std::is_same_v<T, double>)
+		return _mm512_loadu_pd(p);
+	else
+		return _mm512_loadu_si512(p);
+}
+
+template<vector_item T>
+FV_TARGET_AVX512 inline auto avx512_set1(T value)
+{
+	if constexpr (std::is_same_v<T, float>)
+		return _mm512_set1_ps(value);
+	else if constexpr (std::is_same_v<T, double>)
+		return _mm512_set1_pd(value);
+	else if constexpr (sizeof(T) == 1)
+		return _mm512_set1_epi8(static_cast<char>(value));
+	else if constexpr (sizeof(T) == 2)
+		return _mm512_set1_epi16(static_cast<short>(value));
+	else if constexpr (sizeof(T) == 4)
+		return _mm512_set1_epi32(static_cast<int>(value));
+	else
+		return _mm512_set1_epi64(static_cast<long long>(value));
+}
+
+template<vector_item T, class reg_t>
+FV_TARGET_AVX512 inline uint64_t avx512_eq_mask(reg_t a, reg_t b)
+{
+	if constexpr (std::is_same_v<T, float>)
+		return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ);
+	else if constexpr (std::is_same_v<T, double>)
+		return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ);
+	else if constexpr (sizeof(T) == 1)
+		return _mm512_cmpeq_epi8_mask(a, b);
+	else if constexpr (sizeof(T) == 2)
+		return _mm512_cmpeq_epi16_mask(a, b);
+	else if constexpr (sizeof(T) == 4)
+		return _mm512_cmpeq_epi32_mask(a, b);
+	else
+		return _mm512_cmpeq_epi64_mask(a, b);
+}
+
+template<vector_item T>
+FV_TARGET_AVX512 inline const T* find_avx512(const T* first, uint32_t count, T value)
+{
+	constexpr uint32_t lanes = 64 / sizeof(T);
+
+	const auto needle = avx512_set1(value);
+
+	uint32_t i = 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		if (const uint64_t mask = avx512_eq_mask<T>(avx512_load(first + i), needle))
+			return first + i + std::countr_zero(mask);
+	}
+
+	return find_scalar(first + i, count - i, value);
+}
+
+template<vector_item T>
+FV_TARGET_AVX512 inline uint32_t count_avx512(const T* first, uint32_t count, T value)
+{
+	constexpr uint32_t lanes = 64 / sizeof(T);
+
+	const auto needle = avx512_set1(value);
+
+	uint32_t result = 0;
+	uint32_t i = 0;
+	for (; i + lanes <= count; i += lanes)
+		result += std::popcount(avx512_eq_mask<T>(avx512_load(first + i), needle));
+
+	return result + count_scalar(first + i, count - i, value);
+}
+
+template<vector_item T, class reg_t>
+FV_TARGET_AVX512 inline reg_t avx512_min(reg_t a, reg_t b)
+{
+	if constexpr (std::is_same_v<T, float>)
+		return _mm512_min_ps(a, b);
+	else if constexpr (std::is_same_v<T, double>)
+		return _mm512_min_pd(a, b);
+	else if constexpr (sizeof(T) == 1)
+		return std::is_signed_v<T> ? _mm512_min_epi8(a, b) : _mm512_min_epu8(a, b);
+	else if constexpr (sizeof(T) == 2)
+		return std::is_signed_v<T> ? _mm512_min_epi16(a, b) : _mm512_min_epu16(a, b);
+	else if constexpr (sizeof(T) == 4)
+		return std::is_signed_v<T> ? _mm512_min_epi32(a, b) : _mm512_min_epu32(a, b);
+	else
+		return std::is_signed_v<T> ? _mm512_min_epi64(a, b) : _mm512_min_epu64(a, b);
+}
+
+template<vector_item T, class reg_t>
+FV_TARGET_AVX512 inline reg_t avx512_max(reg_t a, reg_t b)
+{
+	if constexpr (std::is_same_v<T, float>)
+		return _mm512_max_ps(a, b);
+	else if constexpr (std::is_same_v<T, double>)
+		return _mm512_max_pd(a, b);
+	else if constexpr (sizeof(T) == 1)
+		return std::is_signed_v<T> ? _mm512_max_epi8(a, b) : _mm512_max_epu8(a, b);
+	else if constexpr (sizeof(T) == 2)
+		return std::is_signed_v<T> ? _mm512_max_epi16(a, b) : _mm512_max_epu16(a, b);
+	else if constexpr (sizeof(T) == 4)
+		return std::is_signed_v<T> ? _mm512_max_epi32(a, b) : _mm512_max_epu32(a, b);
+	else
+		return std::is_signed_v<T> ? _mm512_max_epi64(a, b) : _mm512_max_epu64(a, b);
+}
+
+template<vector_item T, class reg_t>
+FV_TARGET_AVX512 inline void avx512_store(T* p, reg_t a)
+{
+	if constexpr (std::is_same_v<T, float>)
+		_mm512_storeu_ps(p, a);
+	else if constexpr (std::is_same_v<T, double>)
+		_mm512_storeu_pd(p, a);
+	else
+		_mm512_storeu_si512(p, a);
+}
+
+template<vector_item T>
+FV_TARGET_AVX512 inline std::pair<T, T> minmax_avx512(const T* first, uint32_t count)
+{
+	constexpr uint32_t lanes = 64 / sizeof(T);
+
+	if (count < lanes)
+		return minmax_scalar(first, count);
+
+	auto lo = avx512_load(first);
+	auto hi = lo;
+
+	uint32_t i = lanes;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const auto items = avx512_load(first + i);
+		lo = avx512_min<T>(lo, items);
+		hi = avx512_max<T>(hi, items);
+	}
+
+	// the last partial block overlaps already seen items, which doesn't change min and max
+	if (i < count)
+	{
+		const auto items = avx512_load(first + count - lanes);
+		lo = avx512_min<T>(lo, items);
+		hi = avx512_max<T>(hi, items);
+	}
+
+	T lo_lanes[lanes];
+	T hi_lanes[lanes];
+	avx512_store(lo_lanes, lo);
+	avx512_store(hi_lanes, hi);
+
+	return { minmax_scalar(lo_lanes, lanes).first, minmax_scalar(hi_lanes, lanes).second };
+}
+
+template<vector_item T>
+FV_TARGET_AVX512 inline sum_type<T> sum_avx512(const T* first, uint32_t count)
+{
+	uint32_t i = 0;
+	sum_type<T> result = 0;
+
+	if constexpr (std::is_same_v<T, float>)
+	{
+		__m512 acc = _mm512_setzero_ps();
+		for (; i + 16 <= count; i += 16)
+			acc = _mm512_add_ps(acc, _mm512_loadu_ps(first + i));
+
+		float lanes[16];
+		_mm512_storeu_ps(lanes, acc);
+		result = sum_scalar(lanes, 16);
+	}
+	else if constexpr (std::is_same_v<T, double>)
+	{
+		__m512d acc = _mm512_setzero_pd();
+		for (; i + 8 <= count; i += 8)
+			acc = _mm512_add_pd(acc, _mm512_loadu_pd(first + i));
+
+		double lanes[8];
+		_mm512_storeu_pd(lanes, acc);
+		result = sum_scalar(lanes, 8);
+	}
+	else
+	{
+		__m512i acc = _mm512_setzero_si512();
+		if constexpr (sizeof(T) == 4)
+		{
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m256i items = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+				acc = _mm512_add_epi64(acc, std::is_signed_v<T> ? _mm512_cvtepi32_epi64(items) : _mm512_cvtepu32_epi64(items));
+			}
+		}
+		else
+		{
+			for (; i + 8 <= count; i += 8)
+				acc = _mm512_add_epi64(acc, _mm512_loadu_si512(first + i));
+		}
+
+		sum_type<T> lanes[8];
+		_mm512_storeu_si512(lanes, acc);
+		for (sum_type<T> lane : lanes)
+			result += lane;
+	}
+
+	return result + sum_scalar(first + i, count - i);
+}
+
+template<compare_op op, vector_item T>
+FV_TARGET_AVX512 inline uint32_t compress_avx512(T* first, uint32_t count, T value)
+{
+	constexpr uint32_t lanes = 64 / sizeof(T);
+
+	constexpr int predicate =
+		op == compare_op::equal ? _MM_CMPINT_EQ :
+		op == compare_op::not_equal ? _MM_CMPINT_NE :
+		op == compare_op::less ? _MM_CMPINT_LT :
+		op == compare_op::less_equal ? _MM_CMPINT_LE :
+		op == compare_op::greater ? _MM_CMPINT_NLE : _MM_CMPINT_NLT;
+
+	constexpr int float_predicate =
+		op == compare_op::equal ? _CMP_EQ_OQ :
+		op == compare_op::not_equal ? _CMP_NEQ_UQ :
+		op == compare_op::less ? _CMP_LT_OQ :
+		op == compare_op::less_equal ? _CMP_LE_OQ :
+		op == compare_op::greater ? _CMP_GT_OQ : _CMP_GE_OQ;
+
+	const auto needle = avx512_set1(value);
+
+	uint32_t kept = 0;
+	uint32_t i = 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const auto items = avx512_load(first + i);
+
+		if constexpr (std::is_same_v<T, float>)
+		{
+			const __mmask16 keep = ~_mm512_cmp_ps_mask(items, needle, float_predicate);
+			_mm512_mask_compressstoreu_ps(first + kept, keep, items);
+			kept += std::popcount(uint32_t(keep));
+		}
+		else if constexpr (std::is_same_v<T, double>)
+		{
+			const __mmask8 keep = ~_mm512_cmp_pd_mask(items, needle, float_predicate);
+			_mm512_mask_compressstoreu_pd(first + kept, keep, items);
+			kept += std::popcount(uint32_t(keep));
+		}
+		else if constexpr (sizeof(T) == 4)
+		{
+			const __mmask16 keep = ~(std::is_signed_v<T> ? _mm512_cmp_epi32_mask(items, needle, predicate) : _mm512_cmp_epu32_mask(items, needle, predicate));
+			_mm512_mask_compressstoreu_epi32(first + kept, keep, items);
+			kept += std::popcount(uint32_t(keep));
+		}
+		else
+		{
+			const __mmask8 keep = ~(std::is_signed_v<T> ? _mm512_cmp_epi64_mask(items, needle, predicate) : _mm512_cmp_epu64_mask(items, needle, predicate));
+			_mm512_mask_compressstoreu_epi64(first + kept, keep, items);
+			kept += std::popcount(uint32_t(keep));
+		}
+	}
+
+	for (; i < count; ++i)
+	{
+		first[kept] = first[i];
+		kept += !compare_with<op, T>{ value }(first[i]);
+	}
+
+	return kept;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Dispatch
+
+template<simd_item T>
+inline const T* find(const T* first, uint32_t count, T value)
+{
+#if FV_SIMD_X86
+	if constexpr (vector_item<T>)
+	{
+		switch (cpu_isa())
+		{
+		case isa::avx512: return find_avx512(first, count, value);
+		case isa::avx2:   return find_avx2(first, count, value);
+		default: break;
+		}
+	}
+#endif
+	return find_scalar(first, count, value);
+}
+
+template<simd_item T>
+inline uint32_t count(const T* first, uint32_t count, T value)
+{
+#if FV_SIMD_X86
+	if constexpr (vector_item<T>)
+	{
+		switch (cpu_isa())
+		{
+		case isa::avx512: return count_avx512(first, count, value);
+		case isa::avx2:   return count_avx2(first, count, value);
+		default: break;
+		}
+	}
+#endif
+	return count_scalar(first, count, value);
+}
+
+/// <summary>
+/// Min and max of a non-empty range. Result is unspecified if the range holds NaN
+/// </summary>
+template<simd_item T>
+inline std::pair<T, T> minmax(const T* first, uint32_t count)
+{
+#if FV_SIMD_X86
+	if constexpr (vector_item<T>)
+	{
+		switch (cpu_isa())
+		{
+		case isa::avx512: return minmax_avx512(first, count);
+		case isa::avx2:
+			if constexpr (avx2_has_minmax<T>)
+				return minmax_avx2(first, count);
+			break;
+		default: break;
+		}
+	}
+#endif
+	return minmax_scalar(first, count);
+}
+
+/// <summary>
+/// Sum of a range. Integer sums wrap modulo 2^64, floating point sums depend on the summation order of the kernel
+/// </summary>
+template<simd_item T>
+inline sum_type<T> sum(const T* first, uint32_t count)
+{
+#if FV_SIMD_X86
+	if constexpr (vector_item<T> && simd_has_sum<T>)
+	{
+		switch (cpu_isa())
+		{
+		case isa::avx512: return sum_avx512(first, count);
+		case isa::avx2:   return sum_avx2(first, count);
+		default: break;
+		}
+	}
+#endif
+	return sum_scalar(first, count);
+}
+
+/// <summary>
+/// Remove items matching "item op value" keeping the order of the rest, returns the number of kept items
+/// </summary>
+template<compare_op op, simd_item T>
+inline uint32_t compress(T* first, uint32_t count, T value)
+{
+#if FV_SIMD_X86
+	if constexpr (simd_has_compress<T>)
+	{
+		switch (cpu_isa())
+		{
+		case isa::avx512: return compress_avx512<op>(first, count, value);
+		case isa::avx2:   return compress_avx2<op>(first, count, value);
+		default: break;
+		}
+	}
+#endif
+	return compress_scalar(first, count, compare_with<op, T>{ value });
+}
+
+}
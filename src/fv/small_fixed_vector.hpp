@@ -0,0 +1,480 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/// <summary>
+/// Fixed-capacity vector keeping up to inline_n items in-object. On the first push past inline_n the whole capacity
+/// is allocated once and the items are relocated there; from then on it behaves like fixed_vector and never reallocates.
+/// Fits item counts which are small most of the time but have a long tail up to a known limit
+/// </summary>
+/// <typeparam name="T">Items type</typeparam>
+/// <typeparam name="inline_n">Number of items stored in-object</typeparam>
+/// <typeparam name="allocator_t">Allocator the block is taken from on spill</typeparam>
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t = default_allocator<std::remove_cvref_t<T>>>
+class small_fixed_vector
+{
+	static_assert(inline_n > 0, "Inline capacity must be greater than zero");
+	static_assert(std::is_nothrow_move_constructible_v<allocator_t>, "Allocator must be nothrow move constructible");
+public:
+	using value_type = std::remove_cvref_t<T>;
+
+	using ref_type   = value_type&;
+	using cref_type  = value_type const&;
+	using rref_type  = value_type&&;
+
+	using ptr_type   = value_type*;
+	using cptr_type  = value_type const*;
+
+	using iterator = ptr_type;
+	using const_iterator = cptr_type;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	using size_type = uint32_t;
+
+	/// <summary>
+	/// Ctor. Nothing is allocated until the vector holds more than inline_n items
+	/// </summary>
+	/// <param name="capacity"> - total number of items the vector may ever hold</param>
+	explicit small_fixed_vector(size_type capacity);
+
+	/// <summary>
+	/// Ctor with stateful allocator
+	/// </summary>
+	/// <param name="capacity"> - total number of items the vector may ever hold</param>
+	/// <param name="allocator"> - allocator instance the block is taken from on spill</param>
+	small_fixed_vector(size_type capacity, const allocator_t& allocator);
+	~small_fixed_vector() noexcept;
+
+	/// <summary>
+	/// Copy ctor. Items are kept inline if they fit, regardless of where the other vector keeps them
+	/// </summary>
+	small_fixed_vector(const small_fixed_vector& other);
+
+	/// <summary>
+	/// Move ctor. A spilled block is taken over, inline items are relocated. Other vector becomes empty and inline
+	/// </summary>
+	small_fixed_vector(small_fixed_vector&& other) noexcept(std::is_nothrow_move_constructible_v<value_type>);
+
+	/// <summary>
+	/// Copy assignment operator. Capacity and allocator of the other vector are adopted
+	/// </summary>
+	small_fixed_vector& operator=(const small_fixed_vector& other);
+
+	/// <summary>
+	/// Move assignment operator. Capacity and allocator of the other vector are adopted, other vector becomes empty and inline
+	/// </summary>
+	small_fixed_vector& operator=(small_fixed_vector&& other) noexcept(std::is_nothrow_move_constructible_v<value_type>);
+
+	/// <summary>
+	/// Add item to the end (copying)
+	/// </summary>
+	void push_back(cref_type item);
+
+	/// <summary>
+	/// Add item to the end (moving)
+	/// </summary>
+	void push_back(rref_type item);
+
+	/// <summary>
+	/// Emplacing item to the end. The first item past inline_n allocates the block for the whole capacity.
+	/// Throws std::length_error if the vector is full, the check shares the branch taken on spill and costs nothing more
+	/// </summary>
+	template<class... arg_type>
+	void emplace_back(arg_type&&... arg);
+
+	/// <summary>
+	/// Remove item. If index != size()-1, then item will be swapped with the last item and only then last item destroyed
+	/// </summary>
+	/// <param name="index"> - index of removing item</param>
+	void remove(size_type index);
+
+	/// <summary>
+	/// Destroy all items. A spilled block is kept, so the vector never allocates again
+	/// </summary>
+	void clean();
+
+	cref_type operator[](size_type index) const;
+	ref_type  operator[](size_type index);
+
+	cref_type at(size_type index) const;
+	ref_type  at(size_type index);
+
+	size_type size() const;
+	size_type capacity() const;
+	static constexpr size_type inline_capacity() { return inline_n; }
+
+	/// <summary>
+	/// Check if items live in the allocated block rather than in-object
+	/// </summary>
+	bool spilled() const;
+
+	bool full() const;
+	bool empty() const;
+
+	const allocator_t& get_allocator() const;
+
+	iterator begin();
+	iterator end();
+
+	const_iterator cbegin() const;
+	const_iterator cend() const;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	reverse_iterator rbegin();
+	reverse_iterator rend();
+
+	const_reverse_iterator crbegin() const;
+	const_reverse_iterator crend() const;
+
+private:
+	allocator_t allocator_ = {};
+
+	ptr_type data_ = inline_data_();
+	size_type size_ = 0;
+
+	// size of the current block: inline_n until spilled, capacity_ after
+	size_type limit_ = inline_n;
+	size_type capacity_ = 0;
+
+	alignas(value_type) std::byte storage_[inline_n * sizeof(value_type)];
+
+	ptr_type inline_data_();
+	cptr_type inline_data_() const;
+
+	template<class... arg_type>
+	void spill_emplace_(arg_type&&... arg);
+
+	void release_();
+	void take_(small_fixed_vector&& other);
+};
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::small_fixed_vector(size_type capacity)
+	: capacity_(capacity)
+{
+	assert(capacity > 0);
+	limit_ = std::min(inline_n, capacity);
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::small_fixed_vector(size_type capacity, const allocator_t& allocator)
+	: allocator_(allocator)
+	, capacity_(capacity)
+{
+	assert(capacity > 0);
+	limit_ = std::min(inline_n, capacity);
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::~small_fixed_vector() noexcept
+{
+	release_();
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::small_fixed_vector(const small_fixed_vector& other)
+	: allocator_(other.allocator_)
+	, capacity_(other.capacity_)
+{
+	limit_ = std::min(inline_n, capacity_);
+
+	if (other.size_ > limit_)
+	{
+		data_ = allocator_.allocate(capacity_);
+		assert(data_);
+		limit_ = capacity_;
+	}
+
+	fv_detail::uninitialized_copy_n(other.data_, other.size_, data_);
+	size_ = other.size_;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::small_fixed_vector(small_fixed_vector&& other) noexcept(std::is_nothrow_move_constructible_v<value_type>)
+	: allocator_(std::move(other.allocator_))
+{
+	take_(std::move(other));
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>& small_fixed_vector<T, inline_n, allocator_t>::operator=(const small_fixed_vector& other)
+{
+	if (this == &other)
+		return *this;
+
+	// copy first, so a throwing copy leaves this vector untouched
+	small_fixed_vector copy(other);
+	return *this = std::move(copy);
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>& small_fixed_vector<T, inline_n, allocator_t>::operator=(small_fixed_vector&& other) noexcept(std::is_nothrow_move_constructible_v<value_type>)
+{
+	if (this == &other)
+		return *this;
+
+	// our block must be returned to the allocator it was taken from, so the other's allocator is adopted only after release
+	release_();
+	allocator_ = std::move(other.allocator_);
+	take_(std::move(other));
+
+	return *this;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void small_fixed_vector<T, inline_n, allocator_t>::push_back(cref_type item)
+{
+	emplace_back(item);
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void small_fixed_vector<T, inline_n, allocator_t>::push_back(rref_type item)
+{
+	emplace_back(std::move(item));
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+template<class ...arg_type>
+inline void small_fixed_vector<T, inline_n, allocator_t>::emplace_back(arg_type&& ...arg)
+{
+	if (size_ == limit_) [[unlikely]]
+	{
+		spill_emplace_(std::forward<arg_type>(arg)...);
+		return;
+	}
+
+	std::construct_at(data_ + size_, std::forward<arg_type>(arg)...);
+	++size_;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+template<class ...arg_type>
+inline void small_fixed_vector<T, inline_n, allocator_t>::spill_emplace_(arg_type&& ...arg)
+{
+	// a spilled vector only gets here when full, it never takes a second block
+	if (size_ == capacity_)
+		throw std::length_error("small_fixed_vector is full");
+
+	ptr_type block = allocator_.allocate(capacity_);
+	assert(block);
+
+	// the new item is built before the old ones move, arguments may refer to them
+	try
+	{
+		std::construct_at(block + size_, std::forward<arg_type>(arg)...);
+	}
+	catch (...)
+	{
+		allocator_.deallocate(block, capacity_);
+		throw;
+	}
+
+	fv_detail::uninitialized_relocate_n(data_, size_, block);
+
+	data_ = block;
+	limit_ = capacity_;
+	++size_;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void small_fixed_vector<T, inline_n, allocator_t>::remove(size_type index)
+{
+	assert(index < size_);
+
+	if (index != size_-1)
+		std::swap(data_[index], data_[size_-1]);
+
+	std::destroy_at(&data_[size_-1]);
+	--size_;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void small_fixed_vector<T, inline_n, allocator_t>::clean()
+{
+	std::destroy_n(data_, size_);
+	size_ = 0;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::cref_type small_fixed_vector<T, inline_n, allocator_t>::operator[](size_type index) const
+{
+	return data_[index];
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::ref_type small_fixed_vector<T, inline_n, allocator_t>::operator[](size_type index)
+{
+	return data_[index];
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::cref_type small_fixed_vector<T, inline_n, allocator_t>::at(size_type index) const
+{
+	assert(index < size_);
+	return data_[index];
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::ref_type small_fixed_vector<T, inline_n, allocator_t>::at(size_type index)
+{
+	assert(index < size_);
+	return data_[index];
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::size_type small_fixed_vector<T, inline_n, allocator_t>::size() const
+{
+	return size_;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::size_type small_fixed_vector<T, inline_n, allocator_t>::capacity() const
+{
+	return capacity_;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool small_fixed_vector<T, inline_n, allocator_t>::spilled() const
+{
+	return data_ != inline_data_();
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool small_fixed_vector<T, inline_n, allocator_t>::full() const
+{
+	return size_ == capacity_;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline bool small_fixed_vector<T, inline_n, allocator_t>::empty() const
+{
+	return size_ == 0;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline const allocator_t& small_fixed_vector<T, inline_n, allocator_t>::get_allocator() const
+{
+	return allocator_;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::iterator small_fixed_vector<T, inline_n, allocator_t>::begin()
+{
+	return data_;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::iterator small_fixed_vector<T, inline_n, allocator_t>::end()
+{
+	return data_ + size_;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::const_iterator small_fixed_vector<T, inline_n, allocator_t>::cbegin() const
+{
+	return data_;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::const_iterator small_fixed_vector<T, inline_n, allocator_t>::cend() const
+{
+	return data_ + size_;
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::const_iterator small_fixed_vector<T, inline_n, allocator_t>::begin() const
+{
+	return cbegin();
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::const_iterator small_fixed_vector<T, inline_n, allocator_t>::end() const
+{
+	return cend();
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::reverse_iterator small_fixed_vector<T, inline_n, allocator_t>::rbegin()
+{
+	return reverse_iterator(end());
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::reverse_iterator small_fixed_vector<T, inline_n, allocator_t>::rend()
+{
+	return reverse_iterator(begin());
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::const_reverse_iterator small_fixed_vector<T, inline_n, allocator_t>::crbegin() const
+{
+	return const_reverse_iterator(cend());
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::const_reverse_iterator small_fixed_vector<T, inline_n, allocator_t>::crend() const
+{
+	return const_reverse_iterator(cbegin());
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::ptr_type small_fixed_vector<T, inline_n, allocator_t>::inline_data_()
+{
+	return std::launder(reinterpret_cast<ptr_type>(storage_));
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline small_fixed_vector<T, inline_n, allocator_t>::cptr_type small_fixed_vector<T, inline_n, allocator_t>::inline_data_() const
+{
+	return std::launder(reinterpret_cast<cptr_type>(storage_));
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void small_fixed_vector<T, inline_n, allocator_t>::release_()
+{
+	std::destroy_n(data_, size_);
+	size_ = 0;
+
+	if (spilled())
+		allocator_.deallocate(data_, capacity_);
+
+	data_ = inline_data_();
+	limit_ = std::min(inline_n, capacity_);
+}
+
+template<class T, uint32_t inline_n, allocator_concept<std::remove_cvref_t<T>> allocator_t>
+inline void small_fixed_vector<T, inline_n, allocator_t>::take_(small_fixed_vector&& other)
+{
+	// expects this vector to be empty and inline, with other's allocator already adopted
+	capacity_ = other.capacity_;
+	size_ = other.size_;
+
+	if (other.spilled())
+	{
+		data_ = other.data_;
+		limit_ = other.limit_;
+	}
+	else
+	{
+		data_ = inline_data_();
+		limit_ = other.limit_;
+		fv_detail::uninitialized_relocate_n(other.data_, other.size_, data_);
+	}
+
+	other.data_ = other.inline_data_();
+	other.size_ = 0;
+	other.limit_ = std::min(inline_n, other.capacity_);
+}
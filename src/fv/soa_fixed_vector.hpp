@@ -0,0 +1,412 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <utility>
+
+/// <summary>
+/// Fixed-capacity vector with Structure-of-Arrays layout. Every field lives in its own contiguous column,
+/// all columns share one memory block allocated once on construction. Columns are aligned inside the block,
+/// so the allocator does not have to align it for the widest column.
+/// Semantics of push_back/emplace_back/remove/clean match fixed_vector, a row is added or removed in every column at once.
+/// </summary>
+/// <typeparam name="allocator_t">Allocator of raw bytes</typeparam>
+/// <typeparam name="Fields">Column types</typeparam>
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+class basic_soa_fixed_vector
+{
+	static_assert(sizeof...(Fields) > 0, "At least one column is required");
+	static_assert(std::is_nothrow_move_constructible_v<allocator_t>, "Allocator must be nothrow move constructible");
+	static_assert((std::same_as<Fields, std::remove_cvref_t<Fields>> && ...), "Columns must be plain value types");
+public:
+	using size_type = uint32_t;
+
+	template<std::size_t I>
+	using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+	static constexpr std::size_t column_count = sizeof...(Fields);
+
+	/// <summary>
+	/// Ctor
+	/// </summary>
+	/// <param name="capacity"> - number of rows in allocated memory block</param>
+	basic_soa_fixed_vector(size_type capacity);
+
+	/// <summary>
+	/// Ctor with stateful allocator
+	/// </summary>
+	/// <param name="capacity"> - number of rows in allocated memory block</param>
+	/// <param name="allocator"> - allocator instance the memory block is taken from</param>
+	basic_soa_fixed_vector(size_type capacity, const allocator_t& allocator);
+	~basic_soa_fixed_vector() noexcept;
+
+	/// <summary>
+	/// Copy ctor
+	/// </summary>
+	basic_soa_fixed_vector(const basic_soa_fixed_vector& other);
+
+	/// <summary>
+	/// Move ctor
+	/// </summary>
+	basic_soa_fixed_vector(basic_soa_fixed_vector&& other) noexcept;
+
+	/// <summary>
+	/// Copy assignment operator. Memory block is reallocated with capacity of other vector
+	/// </summary>
+	basic_soa_fixed_vector& operator=(const basic_soa_fixed_vector& other);
+
+	/// <summary>
+	/// Move assignment operator
+	/// </summary>
+	basic_soa_fixed_vector& operator=(basic_soa_fixed_vector&& other) noexcept;
+
+	/// <summary>
+	/// Add row to the end (copying)
+	/// </summary>
+	void push_back(const Fields&... fields);
+
+	/// <summary>
+	/// Emplacing row to the end, one argument per column
+	/// </summary>
+	template<class... arg_type>
+		requires (sizeof...(arg_type) == sizeof...(Fields))
+	void emplace_back(arg_type&&... arg);
+
+	/// <summary>
+	/// Remove row. If index != size()-1, then row will be swapped with the last row and only then last row destroyed
+	/// </summary>
+	/// <param name="index"> - index of removing row</param>
+	void remove(size_type index);
+
+	/// <summary>
+	/// Destroy all rows
+	/// </summary>
+	void clean();
+
+	/// <summary>
+	/// Contiguous column of I-th field
+	/// </summary>
+	template<std::size_t I>
+	std::span<field_type<I>> column();
+
+	template<std::size_t I>
+	std::span<const field_type<I>> column() const;
+
+	/// <summary>
+	/// I-th field of the row
+	/// </summary>
+	template<std::size_t I>
+	field_type<I>& get(size_type index);
+
+	template<std::size_t I>
+	const field_type<I>& get(size_type index) const;
+
+	size_type size() const;
+	size_type capacity() const;
+
+	bool full() const;
+	bool empty() const;
+
+private:
+	using columns_type = std::tuple<Fields*...>;
+	using indices_type = std::index_sequence_for<Fields...>;
+
+	// the block is padded so the columns can start at this alignment whatever the allocator returns
+	static constexpr std::size_t block_alignment_ = std::max({ alignof(Fields)... });
+
+	allocator_t allocator_ = {};
+
+	std::byte* block_ = nullptr;
+	columns_type columns_ = {};
+	size_type capacity_ = 0;
+	size_type size_ = 0;
+
+	static std::size_t block_size_(size_type capacity);
+
+	void allocate_(size_type capacity);
+	void release_();
+
+	template<std::size_t I, class args_tuple>
+	void construct_row_(size_type index, args_tuple&& args);
+
+	template<std::size_t I>
+	void copy_columns_(const basic_soa_fixed_vector& other);
+};
+
+template<class... Fields>
+using soa_fixed_vector = basic_soa_fixed_vector<default_allocator<std::byte>, Fields...>;
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline basic_soa_fixed_vector<allocator_t, Fields...>::basic_soa_fixed_vector(size_type capacity)
+{
+	allocate_(capacity);
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline basic_soa_fixed_vector<allocator_t, Fields...>::basic_soa_fixed_vector(size_type capacity, const allocator_t& allocator)
+	: allocator_(allocator)
+{
+	allocate_(capacity);
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline basic_soa_fixed_vector<allocator_t, Fields...>::~basic_soa_fixed_vector() noexcept
+{
+	release_();
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline basic_soa_fixed_vector<allocator_t, Fields...>::basic_soa_fixed_vector(const basic_soa_fixed_vector& other)
+	: allocator_(other.allocator_)
+{
+	allocate_(other.capacity_);
+
+	try
+	{
+		copy_columns_<0>(other);
+	}
+	catch (...)
+	{
+		allocator_.deallocate(block_, static_cast<uint32_t>(block_size_(capacity_)));
+		throw;
+	}
+
+	size_ = other.size_;
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline basic_soa_fixed_vector<allocator_t, Fields...>::basic_soa_fixed_vector(basic_soa_fixed_vector&& other) noexcept
+	: allocator_(std::move(other.allocator_))
+	, block_(std::exchange(other.block_, nullptr))
+	, columns_(std::exchange(other.columns_, columns_type{}))
+	, capacity_(std::exchange(other.capacity_, 0))
+	, size_(std::exchange(other.size_, 0))
+{
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline basic_soa_fixed_vector<allocator_t, Fields...>& basic_soa_fixed_vector<allocator_t, Fields...>::operator=(const basic_soa_fixed_vector& other)
+{
+	if (this == &other)
+		return *this;
+
+	// copy first, so a throwing copy leaves this vector untouched
+	basic_soa_fixed_vector copy(other);
+	return *this = std::move(copy);
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline basic_soa_fixed_vector<allocator_t, Fields...>& basic_soa_fixed_vector<allocator_t, Fields...>::operator=(basic_soa_fixed_vector&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	release_();
+
+	allocator_ = std::move(other.allocator_);
+	block_ = std::exchange(other.block_, nullptr);
+	columns_ = std::exchange(other.columns_, columns_type{});
+	capacity_ = std::exchange(other.capacity_, 0);
+	size_ = std::exchange(other.size_, 0);
+
+	return *this;
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline void basic_soa_fixed_vector<allocator_t, Fields...>::push_back(const Fields&... fields)
+{
+	emplace_back(fields...);
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+template<class... arg_type>
+	requires (sizeof...(arg_type) == sizeof...(Fields))
+inline void basic_soa_fixed_vector<allocator_t, Fields...>::emplace_back(arg_type&&... arg)
+{
+	assert(block_);
+	assert(size_ < capacity_);
+
+	construct_row_<0>(size_, std::forward_as_tuple(std::forward<arg_type>(arg)...));
+	++size_;
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline void basic_soa_fixed_vector<allocator_t, Fields...>::remove(size_type index)
+{
+	assert(index < size_);
+
+	const size_type last = size_ - 1;
+	[&]<std::size_t... I>(std::index_sequence<I...>) {
+		([&](auto* column) {
+			if (index != last)
+				std::swap(column[index], column[last]);
+
+			std::destroy_at(&column[last]);
+		}(std::get<I>(columns_)), ...);
+	}(indices_type{});
+
+	--size_;
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline void basic_soa_fixed_vector<allocator_t, Fields...>::clean()
+{
+	[&]<std::size_t... I>(std::index_sequence<I...>) {
+		(std::destroy_n(std::get<I>(columns_), size_), ...);
+	}(indices_type{});
+
+	size_ = 0;
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+template<std::size_t I>
+inline auto basic_soa_fixed_vector<allocator_t, Fields...>::column() -> std::span<field_type<I>>
+{
+	return { std::get<I>(columns_), size_ };
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+template<std::size_t I>
+inline auto basic_soa_fixed_vector<allocator_t, Fields...>::column() const -> std::span<const field_type<I>>
+{
+	return { std::get<I>(columns_), size_ };
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+template<std::size_t I>
+inline auto basic_soa_fixed_vector<allocator_t, Fields...>::get(size_type index) -> field_type<I>&
+{
+	assert(index < size_);
+	return std::get<I>(columns_)[index];
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+template<std::size_t I>
+inline auto basic_soa_fixed_vector<allocator_t, Fields...>::get(size_type index) const -> const field_type<I>&
+{
+	assert(index < size_);
+	return std::get<I>(columns_)[index];
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline basic_soa_fixed_vector<allocator_t, Fields...>::size_type basic_soa_fixed_vector<allocator_t, Fields...>::size() const
+{
+	return size_;
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline basic_soa_fixed_vector<allocator_t, Fields...>::size_type basic_soa_fixed_vector<allocator_t, Fields...>::capacity() const
+{
+	return capacity_;
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline bool basic_soa_fixed_vector<allocator_t, Fields...>::full() const
+{
+	return size_ == capacity_;
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline bool basic_soa_fixed_vector<allocator_t, Fields...>::empty() const
+{
+	return size_ == 0;
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline std::size_t basic_soa_fixed_vector<allocator_t, Fields...>::block_size_(size_type capacity)
+{
+	// same layout as allocate_(), plus room to move the first column to an aligned address
+	std::size_t size = 0;
+	((size = (size + alignof(Fields) - 1) / alignof(Fields) * alignof(Fields) + std::size_t(capacity) * sizeof(Fields)), ...);
+	return size + block_alignment_ - 1;
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline void basic_soa_fixed_vector<allocator_t, Fields...>::allocate_(size_type capacity)
+{
+	assert(capacity > 0);
+
+	const std::size_t bytes = block_size_(capacity);
+	assert(bytes <= UINT32_MAX);
+
+	block_ = allocator_.allocate(static_cast<uint32_t>(bytes));
+	assert(block_);
+
+	// columns follow each other in declaration order, each aligned for its type
+	std::byte* const base = block_ + (-reinterpret_cast<uintptr_t>(block_) & (block_alignment_ - 1));
+	std::size_t offset = 0;
+	[&]<std::size_t... I>(std::index_sequence<I...>) {
+		([&](auto*& column) {
+			using field_t = std::remove_pointer_t<std::remove_reference_t<decltype(column)>>;
+
+			offset = (offset + alignof(field_t) - 1) / alignof(field_t) * alignof(field_t);
+			column = reinterpret_cast<field_t*>(base + offset);
+			offset += std::size_t(capacity) * sizeof(field_t);
+		}(std::get<I>(columns_)), ...);
+	}(indices_type{});
+
+	capacity_ = capacity;
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+inline void basic_soa_fixed_vector<allocator_t, Fields...>::release_()
+{
+	if (block_)
+	{
+		clean();
+
+		allocator_.deallocate(block_, static_cast<uint32_t>(block_size_(capacity_)));
+		block_ = nullptr;
+		columns_ = {};
+		capacity_ = 0;
+	}
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+template<std::size_t I, class args_tuple>
+inline void basic_soa_fixed_vector<allocator_t, Fields...>::construct_row_(size_type index, args_tuple&& args)
+{
+	if constexpr (I < sizeof...(Fields))
+	{
+		field_type<I>* item = std::get<I>(columns_) + index;
+		std::construct_at(item, std::get<I>(std::move(args)));
+
+		// keep the row all-or-nothing if one of the next columns throws
+		try
+		{
+			construct_row_<I + 1>(index, std::move(args));
+		}
+		catch (...)
+		{
+			std::destroy_at(item);
+			throw;
+		}
+	}
+}
+
+template<allocator_concept<std::byte> allocator_t, class... Fields>
+template<std::size_t I>
+inline void basic_soa_fixed_vector<allocator_t, Fields...>::copy_columns_(const basic_soa_fixed_vector& other)
+{
+	if constexpr (I < sizeof...(Fields))
+	{
+		fv_detail::uninitialized_copy_n(std::get<I>(other.columns_), other.size_, std::get<I>(columns_));
+
+		// destroy copied columns if one of the next columns throws
+		try
+		{
+			copy_columns_<I + 1>(other);
+		}
+		catch (...)
+		{
+			std::destroy_n(std::get<I>(columns_), other.size_);
+			throw;
+		}
+	}
+}
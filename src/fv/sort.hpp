@@ -0,0 +1,315 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fv_detail
+{
+
+/// <summary>
+/// Keys radix sort can order by their bits: integers (but bool) and 32/64-bit floating point numbers
+/// </summary>
+template<class T>
+concept radix_key = (std::integral<T> && !std::same_as<T, bool>) || (std::floating_point<T> && (sizeof(T) == 4 || sizeof(T) == 8));
+
+template<class T, class key_fn>
+using radix_key_t = std::remove_cvref_t<std::invoke_result_t<key_fn&, const T&>>;
+
+/// <summary>
+/// Items radix sort can handle: trivially copyable (they are scattered between buffers by copying) with an arithmetic key
+/// </summary>
+template<class T, class key_fn>
+concept radix_sortable = std::is_trivially_copyable_v<T> && std::invocable<key_fn&, const T&> && radix_key<radix_key_t<T, key_fn>>;
+
+template<std::size_t size> struct unsigned_of_size;
+template<> struct unsigned_of_size<1> { using type = uint8_t; };
+template<> struct unsigned_of_size<2> { using type = uint16_t; };
+template<> struct unsigned_of_size<4> { using type = uint32_t; };
+template<> struct unsigned_of_size<8> { using type = uint64_t; };
+
+/// <summary>
+/// Map key to unsigned bits with the same order: the sign bit of signed integers is flipped,
+/// negative floats have all bits flipped and positive ones only the sign bit. -0.0 goes before 0.0, NaNs go to the ends
+/// </summary>
+template<radix_key T>
+inline auto radix_bits(T key)
+{
+	using bits_t = typename unsigned_of_size<sizeof(T)>::type;
+	constexpr bits_t sign = bits_t(bits_t(1) << (sizeof(T) * 8 - 1));
+
+	const bits_t bits = std::bit_cast<bits_t>(key);
+
+	if constexpr (std::floating_point<T>)
+		return (bits & sign) ? bits_t(~bits) : bits_t(bits | sign);
+	else if constexpr (std::is_signed_v<T>)
+		return bits_t(bits ^ sign);
+	else
+		return bits;
+}
+
+/// <summary>
+/// Below this size the histograms cost more than sorting itself, a comparison sort is used
+/// </summary>
+inline constexpr std::size_t radix_sort_min_size = 256;
+
+/// <summary>
+/// From this size sort() splits the work between threads
+/// </summary>
+inline constexpr std::size_t parallel_sort_min_size = std::size_t(1) << 20;
+
+/// <summary>
+/// Stable LSD radix sort by 8-bit digits. Result is left in data, scratch must hold size items
+/// </summary>
+template<class T, class key_fn>
+inline void radix_sort_n(T* data, T* scratch, std::size_t size, key_fn& key)
+{
+	using bits_t = decltype(radix_bits(key(*data)));
+	constexpr std::size_t passes = sizeof(bits_t);
+
+	if (size < radix_sort_min_size)
+	{
+		std::stable_sort(data, data + size, [&key](const T& a, const T& b) { return radix_bits(key(a)) < radix_bits(key(b)); });
+		return;
+	}
+
+	// histograms of all digits are gathered in one read pass
+	std::array<std::array<std::size_t, 256>, passes> counts = {};
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		const bits_t bits = radix_bits(key(data[i]));
+		for (std::size_t pass = 0; pass < passes; ++pass)
+			++counts[pass][(bits >> (pass * 8)) & 0xff];
+	}
+
+	T* src = data;
+	T* dst = scratch;
+
+	for (std::size_t pass = 0; pass < passes; ++pass)
+	{
+		std::array<std::size_t, 256>& offsets = counts[pass];
+
+		// digit shared by all items would not change the order
+		if (offsets[(radix_bits(key(src[0])) >> (pass * 8)) & 0xff] == size)
+			continue;
+
+		std::size_t sum = 0;
+		for (std::size_t& offset : offsets)
+			sum += std::exchange(offset, sum);
+
+		for (std::size_t i = 0; i < size; ++i)
+			dst[offsets[(radix_bits(key(src[i])) >> (pass * 8)) & 0xff]++] = src[i];
+
+		std::swap(src, dst);
+	}
+
+	if (src != data)
+		std::memcpy(static_cast<void*>(data), static_cast<const void*>(src), size * sizeof(T));
+}
+
+template<class fn_t>
+inline void run_on_threads(uint32_t thread_count, fn_t&& fn)
+{
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count - 1);
+
+	for (uint32_t i = 1; i < thread_count; ++i)
+		threads.emplace_back([&fn, i] { fn(i); });
+
+	fn(0);
+
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+/// <summary>
+/// Stable parallel sample sort. Splitters picked from an evenly spaced sample cut the keys into one bucket per thread,
+/// every thread scatters its chunk into the buckets in scratch and then radix sorts one bucket back into data
+/// </summary>
+template<class T, class key_fn>
+inline void parallel_sort_n(T* data, T* scratch, std::size_t size, key_fn& key, uint32_t thread_count)
+{
+	using bits_t = decltype(radix_bits(key(*data)));
+	constexpr std::size_t oversampling = 32;
+
+	const std::size_t buckets = thread_count;
+
+	std::vector<bits_t> samples(buckets * oversampling);
+	for (std::size_t i = 0; i < samples.size(); ++i)
+		samples[i] = radix_bits(key(data[i * size / samples.size()]));
+	std::sort(samples.begin(), samples.end());
+
+	std::vector<bits_t> splitters(buckets - 1);
+	for (std::size_t i = 0; i < splitters.size(); ++i)
+		splitters[i] = samples[(i + 1) * oversampling];
+
+	auto bucket_of = [&](const T& item) -> std::size_t {
+		return std::upper_bound(splitters.begin(), splitters.end(), radix_bits(key(item))) - splitters.begin();
+	};
+	auto chunk_begin = [&](uint32_t chunk) { return size * chunk / thread_count; };
+
+	// offsets[chunk * buckets + bucket]: number of chunk's items in bucket, then the position the first of them goes to
+	std::vector<std::size_t> offsets(std::size_t(thread_count) * buckets);
+
+	run_on_threads(thread_count, [&](uint32_t chunk) {
+		std::vector<std::size_t> counts(buckets);
+		for (std::size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i)
+			++counts[bucket_of(data[i])];
+
+		std::copy(counts.begin(), counts.end(), offsets.begin() + chunk * buckets);
+	});
+
+	// bucket-major prefix sum: items of chunk i are placed before the ones of chunk i+1 in every bucket, keeping sort stable
+	std::vector<std::size_t> bucket_begin(buckets + 1);
+	std::size_t sum = 0;
+	for (std::size_t bucket = 0; bucket < buckets; ++bucket)
+	{
+		bucket_begin[bucket] = sum;
+		for (uint32_t chunk = 0; chunk < thread_count; ++chunk)
+			sum += std::exchange(offsets[chunk * buckets + bucket], sum);
+	}
+	bucket_begin[buckets] = size;
+
+	run_on_threads(thread_count, [&](uint32_t chunk) {
+		std::vector<std::size_t> positions(offsets.begin() + chunk * buckets, offsets.begin() + (chunk + 1) * buckets);
+		for (std::size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i)
+			scratch[positions[bucket_of(data[i])]++] = data[i];
+	});
+
+	run_on_threads(thread_count, [&](uint32_t bucket) {
+		const std::size_t first = bucket_begin[bucket];
+		const std::size_t count = bucket_begin[bucket + 1] - first;
+		if (count == 0)
+			return;
+
+		std::memcpy(static_cast<void*>(data + first), static_cast<const void*>(scratch + first), count * sizeof(T));
+		radix_sort_n(data + first, scratch + first, count, key);
+	});
+}
+
+/// <summary>
+/// Temporary buffer of the vector's size taken from a copy of its allocator
+/// </summary>
+template<class T, class allocator_t, class overflow_t>
+class sort_scratch
+{
+public:
+	using value_type = typename fixed_vector<T, allocator_t, overflow_t>::value_type;
+
+	explicit sort_scratch(const fixed_vector<T, allocator_t, overflow_t>& vec)
+		: allocator_(vec.get_allocator())
+		, size_(vec.size())
+		, data_(allocator_.allocate(size_))
+	{
+		assert(data_);
+	}
+
+	~sort_scratch() noexcept
+	{
+		allocator_.deallocate(data_, size_);
+	}
+
+	sort_scratch(const sort_scratch&) = delete;
+	sort_scratch& operator=(const sort_scratch&) = delete;
+
+	value_type* data() const { return data_; }
+
+private:
+	allocator_t allocator_;
+	uint32_t size_;
+	value_type* data_;
+};
+
+inline uint32_t default_thread_count()
+{
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+}
+
+/// <summary>
+/// Sort items by key(item) in ascending order with LSD radix sort on a single thread.
+/// The scratch buffer is taken from the vector's own allocator. The sort is stable
+/// </summary>
+/// <param name="key"> - maps an item to an integral or floating point key, the item itself by default</param>
+template<class T, class allocator_t, class overflow_t, class key_fn = std::identity>
+	requires fv_detail::radix_sortable<typename fixed_vector<T, allocator_t, overflow_t>::value_type, key_fn>
+inline void radix_sort(fixed_vector<T, allocator_t, overflow_t>& vec, key_fn key = {})
+{
+	if (vec.size() < 2)
+		return;
+
+	fv_detail::sort_scratch scratch(vec);
+	fv_detail::radix_sort_n(vec.begin(), scratch.data(), vec.size(), key);
+}
+
+/// <summary>
+/// Sort items by key(item) in ascending order with parallel sample sort, buckets are radix sorted.
+/// The scratch buffer is taken from the vector's own allocator. The sort is stable
+/// </summary>
+/// <param name="key"> - maps an item to an integral or floating point key, the item itself by default</param>
+/// <param name="thread_count"> - number of threads, 0 for std::thread::hardware_concurrency()</param>
+template<class T, class allocator_t, class overflow_t, class key_fn = std::identity>
+	requires fv_detail::radix_sortable<typename fixed_vector<T, allocator_t, overflow_t>::value_type, key_fn>
+inline void parallel_sort(fixed_vector<T, allocator_t, overflow_t>& vec, key_fn key = {}, uint32_t thread_count = 0)
+{
+	if (thread_count == 0)
+		thread_count = fv_detail::default_thread_count();
+
+	if (vec.size() < 2)
+		return;
+
+	fv_detail::sort_scratch scratch(vec);
+	if (thread_count == 1 || vec.size() < std::size_t(thread_count) * fv_detail::radix_sort_min_size)
+		fv_detail::radix_sort_n(vec.begin(), scratch.data(), vec.size(), key);
+	else
+		fv_detail::parallel_sort_n(vec.begin(), scratch.data(), vec.size(), key, thread_count);
+}
+
+/// <summary>
+/// Sort items by key(item) in ascending order. Radix sortable items are radix sorted, on all cores for large vectors;
+/// other items fall back to std::sort comparing keys
+/// </summary>
+/// <param name="key"> - maps an item to a comparable key, the item itself by default</param>
+template<class T, class allocator_t, class overflow_t, class key_fn = std::identity>
+inline void sort(fixed_vector<T, allocator_t, overflow_t>& vec, key_fn key = {})
+{
+	using value_type = typename fixed_vector<T, allocator_t, overflow_t>::value_type;
+
+	if constexpr (fv_detail::radix_sortable<value_type, key_fn>)
+	{
+		if (vec.size() >= fv_detail::parallel_sort_min_size)
+			parallel_sort(vec, key);
+		else
+			radix_sort(vec, key);
+	}
+	else
+	{
+		std::sort(vec.begin(), vec.end(), [&key](const value_type& a, const value_type& b) { return key(a) < key(b); });
+	}
+}
+
+/// <summary>
+/// Stable sort() ordering items by key(item). Radix sort is stable already, other items fall back to std::stable_sort
+/// </summary>
+template<class T, class allocator_t, class overflow_t, class key_fn = std::identity>
+inline void stable_sort(fixed_vector<T, allocator_t, overflow_t>& vec, key_fn key = {})
+{
+	using value_type = typename fixed_vector<T, allocator_t, overflow_t>::value_type;
+
+	if constexpr (fv_detail::radix_sortable<value_type, key_fn>)
+		::sort(vec, key);
+	else
+		std::stable_sort(vec.begin(), vec.end(), [&key](const value_type& a, const value_type& b) { return key(a) < key(b); });
+}
@@ -0,0 +1,392 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// Counters shared by all vectors registered under one name. Updated with relaxed atomics, so vectors of different threads may share them
+/// </summary>
+struct container_stats
+{
+	std::atomic<uint64_t> allocations = 0;
+	std::atomic<uint64_t> deallocations = 0;
+	std::atomic<uint64_t> bytes_allocated = 0;
+	std::atomic<uint64_t> live_bytes = 0;
+	std::atomic<uint64_t> peak_live_bytes = 0;
+
+	std::atomic<uint32_t> max_capacity = 0;
+	std::atomic<uint32_t> peak_size = 0;
+
+	/// <summary>
+	/// Highest size / capacity ever seen by one vector, in millionths
+	/// </summary>
+	std::atomic<uint32_t> peak_occupancy_ppm = 0;
+
+	std::atomic<uint64_t> pushed = 0;
+	std::atomic<uint64_t> removed = 0;
+	std::atomic<uint64_t> cleans = 0;
+
+	/// <summary>
+	/// How many times a vector became full and for how long vectors stayed full
+	/// </summary>
+	std::atomic<uint64_t> times_full = 0;
+	std::atomic<uint64_t> full_ns = 0;
+};
+
+/// <summary>
+/// Plain copy of container_stats taken at one moment
+/// </summary>
+struct container_stats_snapshot
+{
+	std::string name;
+
+	uint64_t allocations = 0;
+	uint64_t deallocations = 0;
+	uint64_t bytes_allocated = 0;
+	uint64_t live_bytes = 0;
+	uint64_t peak_live_bytes = 0;
+
+	uint32_t max_capacity = 0;
+	uint32_t peak_size = 0;
+	double peak_occupancy = 0.0;
+
+	uint64_t pushed = 0;
+	uint64_t removed = 0;
+	uint64_t cleans = 0;
+
+	uint64_t times_full = 0;
+	std::chrono::nanoseconds time_full = {};
+};
+
+/// <summary>
+/// Process-wide table of container_stats by name. Entries are created on first use and live until the process ends,
+/// so references to them never dangle
+/// </summary>
+class stats_registry
+{
+public:
+	static stats_registry& instance();
+
+	/// <summary>
+	/// Counters registered under name, created on first call. Thread-safe
+	/// </summary>
+	container_stats& get(std::string_view name);
+
+	/// <summary>
+	/// Copies of all counters, ordered by name. Thread-safe
+	/// </summary>
+	std::vector<container_stats_snapshot> snapshot() const;
+
+	/// <summary>
+	/// Write one line per name with its counters. Thread-safe
+	/// </summary>
+	void dump(std::ostream& out) const;
+
+	/// <summary>
+	/// Zero all counters, names stay registered. Thread-safe, but vectors alive at the moment make live_bytes inexact
+	/// </summary>
+	void reset();
+
+private:
+	stats_registry() = default;
+
+	mutable std::mutex mutex_;
+	std::map<std::string, std::unique_ptr<container_stats>, std::less<>> stats_;
+};
+
+namespace fv_detail
+{
+
+template<class T>
+inline void atomic_max(std::atomic<T>& target, T value)
+{
+	T current = target.load(std::memory_order_relaxed);
+	while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+}
+
+/// <summary>
+/// Allocator decorator recording how vectors use their blocks: allocations and bytes, peak size relative to capacity,
+/// pushed, removed and cleaned items and time spent full. Counters go to the stats_registry entry of the given name.
+/// Blocks come from the inner allocator, discard() is forwarded if the inner allocator supports it
+/// </summary>
+/// <typeparam name="T">Items type</typeparam>
+/// <typeparam name="inner_t">Allocator the blocks are taken from</typeparam>
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t = default_allocator<std::remove_cvref_t<T>>>
+class stats_allocator
+{
+	using clock = std::chrono::steady_clock;
+public:
+	using value_type = std::remove_cvref_t<T>;
+	using size_type = uint32_t;
+
+	/// <summary>
+	/// Ctor. Counters go to the "default" entry
+	/// </summary>
+	stats_allocator();
+
+	/// <summary>
+	/// Ctor
+	/// </summary>
+	/// <param name="name"> - stats_registry entry the counters go to</param>
+	/// <param name="inner"> - allocator the blocks are taken from</param>
+	explicit stats_allocator(std::string_view name, const inner_t& inner = {});
+
+	~stats_allocator() noexcept = default;
+
+	/// <summary>
+	/// Copies count into the same entry, but track whether their own vector is full.
+	/// Moves take over the full period with the vector, the source is left not full so the period is counted once
+	/// </summary>
+	stats_allocator(const stats_allocator& other);
+	stats_allocator(stats_allocator&& other) noexcept;
+	stats_allocator& operator=(const stats_allocator& other);
+	stats_allocator& operator=(stats_allocator&& other) noexcept;
+
+	value_type* allocate(size_type size);
+	void deallocate(value_type* p, size_type size);
+
+	void discard(value_type* p, size_type size) requires discarding_allocator_concept<inner_t, value_type>;
+
+	/// <summary>
+	/// Called by fixed_vector after every change of its size
+	/// </summary>
+	void observe(container_event event, size_type count, size_type size, size_type capacity);
+
+	const container_stats& stats() const;
+
+private:
+	inner_t inner_ = {};
+	container_stats* stats_ = nullptr;
+
+	bool full_ = false;
+	clock::time_point full_since_ = {};
+
+	void leave_full_();
+	static constexpr uint64_t n_bytes_(size_type size) { return uint64_t(size) * sizeof(value_type); }
+};
+
+inline stats_registry& stats_registry::instance()
+{
+	static stats_registry registry;
+	return registry;
+}
+
+inline container_stats& stats_registry::get(std::string_view name)
+{
+	std::lock_guard lock(mutex_);
+
+	auto it = stats_.find(name);
+	if (it == stats_.end())
+		it = stats_.emplace(std::string(name), std::make_unique<container_stats>()).first;
+
+	return *it->second;
+}
+
+inline std::vector<container_stats_snapshot> stats_registry::snapshot() const
+{
+	std::lock_guard lock(mutex_);
+
+	std::vector<container_stats_snapshot> result;
+	result.reserve(stats_.size());
+
+	for (const auto& [name, stats] : stats_)
+	{
+		container_stats_snapshot& s = result.emplace_back();
+		s.name = name;
+		s.allocations = stats->allocations.load(std::memory_order_relaxed);
+		s.deallocations = stats->deallocations.load(std::memory_order_relaxed);
+		s.bytes_allocated = stats->bytes_allocated.load(std::memory_order_relaxed);
+		s.live_bytes = stats->live_bytes.load(std::memory_order_relaxed);
+		s.peak_live_bytes = stats->peak_live_bytes.load(std::memory_order_relaxed);
+		s.max_capacity = stats->max_capacity.load(std::memory_order_relaxed);
+		s.peak_size = stats->peak_size.load(std::memory_order_relaxed);
+		s.peak_occupancy = stats->peak_occupancy_ppm.load(std::memory_order_relaxed) / 1e6;
+		s.pushed = stats->pushed.load(std::memory_order_relaxed);
+		s.removed = stats->removed.load(std::memory_order_relaxed);
+		s.cleans = stats->cleans.load(std::memory_order_relaxed);
+		s.times_full = stats->times_full.load(std::memory_order_relaxed);
+		s.time_full = std::chrono::nanoseconds(stats->full_ns.load(std::memory_order_relaxed));
+	}
+
+	return result;
+}
+
+inline void stats_registry::dump(std::ostream& out) const
+{
+	for (const container_stats_snapshot& s : snapshot())
+	{
+		out << s.name
+			<< ": allocations " << s.allocations << " (" << s.bytes_allocated << " bytes, " << s.live_bytes << " live, " << s.peak_live_bytes << " peak)"
+			<< ", peak size " << s.peak_size << " of " << s.max_capacity << " (" << s.peak_occupancy * 100.0 << "%)"
+			<< ", pushed " << s.pushed << ", removed " << s.removed << ", cleans " << s.cleans
+			<< ", full " << s.times_full << " times for " << std::chrono::duration<double, std::milli>(s.time_full).count() << " ms\n";
+	}
+}
+
+inline void stats_registry::reset()
+{
+	std::lock_guard lock(mutex_);
+
+	for (auto& [name, stats] : stats_)
+	{
+		for (std::atomic<uint64_t>* counter : { &stats->allocations, &stats->deallocations, &stats->bytes_allocated, &stats->live_bytes,
+			&stats->peak_live_bytes, &stats->pushed, &stats->removed, &stats->cleans, &stats->times_full, &stats->full_ns })
+			counter->store(0, std::memory_order_relaxed);
+
+		for (std::atomic<uint32_t>* counter : { &stats->max_capacity, &stats->peak_size, &stats->peak_occupancy_ppm })
+			counter->store(0, std::memory_order_relaxed);
+	}
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t>
+inline stats_allocator<T, inner_t>::stats_allocator()
+	: stats_allocator("default")
+{
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t>
+inline stats_allocator<T, inner_t>::stats_allocator(std::string_view name, const inner_t& inner)
+	: inner_(inner)
+	, stats_(&stats_registry::instance().get(name))
+{
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t>
+inline stats_allocator<T, inner_t>::stats_allocator(const stats_allocator& other)
+	: inner_(other.inner_)
+	, stats_(other.stats_)
+{
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t>
+inline stats_allocator<T, inner_t>& stats_allocator<T, inner_t>::operator=(const stats_allocator& other)
+{
+	inner_ = other.inner_;
+	stats_ = other.stats_;
+	full_ = false;
+	return *this;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t>
+inline stats_allocator<T, inner_t>::stats_allocator(stats_allocator&& other) noexcept
+	: inner_(std::move(other.inner_))
+	, stats_(other.stats_)
+	, full_(std::exchange(other.full_, false))
+	, full_since_(other.full_since_)
+{
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t>
+inline stats_allocator<T, inner_t>& stats_allocator<T, inner_t>::operator=(stats_allocator&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	leave_full_();
+
+	inner_ = std::move(other.inner_);
+	stats_ = other.stats_;
+	full_ = std::exchange(other.full_, false);
+	full_since_ = other.full_since_;
+	return *this;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t>
+inline stats_allocator<T, inner_t>::value_type* stats_allocator<T, inner_t>::allocate(size_type size)
+{
+	value_type* p = inner_.allocate(size);
+
+	stats_->allocations.fetch_add(1, std::memory_order_relaxed);
+	stats_->bytes_allocated.fetch_add(n_bytes_(size), std::memory_order_relaxed);
+	fv_detail::atomic_max(stats_->peak_live_bytes, stats_->live_bytes.fetch_add(n_bytes_(size), std::memory_order_relaxed) + n_bytes_(size));
+	fv_detail::atomic_max(stats_->max_capacity, size);
+
+	return p;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t>
+inline void stats_allocator<T, inner_t>::deallocate(value_type* p, size_type size)
+{
+	leave_full_();
+
+	stats_->deallocations.fetch_add(1, std::memory_order_relaxed);
+	stats_->live_bytes.fetch_sub(n_bytes_(size), std::memory_order_relaxed);
+
+	inner_.deallocate(p, size);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t>
+inline void stats_allocator<T, inner_t>::discard(value_type* p, size_type size) requires discarding_allocator_concept<inner_t, value_type>
+{
+	inner_.discard(p, size);
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t>
+inline void stats_allocator<T, inner_t>::observe(container_event event, size_type count, size_type size, size_type capacity)
+{
+	switch (event)
+	{
+	case container_event::push:
+		stats_->pushed.fetch_add(count, std::memory_order_relaxed);
+		fv_detail::atomic_max(stats_->peak_size, size);
+
+		// a moved-from container has no capacity, it is neither full nor occupied
+		if (capacity == 0)
+			break;
+
+		fv_detail::atomic_max(stats_->peak_occupancy_ppm, uint32_t(uint64_t(size) * 1000000 / capacity));
+
+		if (size == capacity && !full_)
+		{
+			full_ = true;
+			full_since_ = clock::now();
+			stats_->times_full.fetch_add(1, std::memory_order_relaxed);
+		}
+		break;
+
+	case container_event::remove:
+		stats_->removed.fetch_add(count, std::memory_order_relaxed);
+		leave_full_();
+		break;
+
+	case container_event::clean:
+		stats_->removed.fetch_add(count, std::memory_order_relaxed);
+		stats_->cleans.fetch_add(1, std::memory_order_relaxed);
+		leave_full_();
+		break;
+	}
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t>
+inline const container_stats& stats_allocator<T, inner_t>::stats() const
+{
+	return *stats_;
+}
+
+template<class T, allocator_concept<std::remove_cvref_t<T>> inner_t>
+inline void stats_allocator<T, inner_t>::leave_full_()
+{
+	if (!full_)
+		return;
+
+	full_ = false;
+	stats_->full_ns.fetch_add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - full_since_).count()), std::memory_order_relaxed);
+}
+
+static_assert(observing_allocator_concept<stats_allocator<int>, int>);
@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include "fixed_vector.hpp"
+#include "os_memory.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// Allocator mapping the whole block as lazily committed virtual memory. Address space for the full capacity is reserved
+/// on construction, physical pages are committed by the OS only when items are written to them,
+/// so a vector sized for the worst case costs only as much memory as it actually holds.
+/// On Windows the full capacity counts against the commit limit from the start, see fv_detail::map_lazy_memory
+/// </summary>
+/// <typeparam name="T">Items type</typeparam>
+/// <typeparam name="discard_on_clean">Give pages of destroyed items back to the OS on fixed_vector::clean()</typeparam>
+template<class T, bool discard_on_clean = false>
+class virtual_memory_allocator
+{
+public:
+	using value_type = std::remove_cvref_t<T>;
+	using size_type = uint32_t;
+
+	virtual_memory_allocator() noexcept = default;
+	~virtual_memory_allocator() noexcept = default;
+	virtual_memory_allocator(const virtual_memory_allocator&) noexcept = default;
+	virtual_memory_allocator(virtual_memory_allocator&&) noexcept = default;
+	virtual_memory_allocator& operator=(const virtual_memory_allocator&) noexcept = default;
+	virtual_memory_allocator& operator=(virtual_memory_allocator&&) noexcept = default;
+
+	inline value_type* allocate(size_type size)
+	{
+		return static_cast<value_type*>(fv_detail::map_lazy_memory(n_bytes_(size)));
+	}
+
+	inline void deallocate(value_type* p, size_type size)
+	{
+		assert(p);
+		fv_detail::unmap_memory(p, n_bytes_(size));
+	}
+
+	/// <summary>
+	/// Give pages of [p, p+size) back to the OS. p must be the beginning of the block
+	/// </summary>
+	inline void discard(value_type* p, size_type size) requires discard_on_clean
+	{
+		assert(p);
+		fv_detail::discard_memory(p, n_bytes_(size));
+	}
+
+private:
+	static constexpr std::size_t n_bytes_(size_type size) { return std::size_t(size) * sizeof(value_type); }
+};
+static_assert(allocator_concept<virtual_memory_allocator<int>, int>);
+static_assert(!discarding_allocator_concept<virtual_memory_allocator<int>, int>);
+static_assert(discarding_allocator_concept<virtual_memory_allocator<int, true>, int>);
@@ -0,0 +1,57 @@
+﻿#include <fv/arena_allocator.hpp>
+
+#include <gtest/gtest.h>
+
+namespace arena_allocator_test
+{
+
+TEST(arena, allocate_and_reset)
+{
+	alignas(16) std::byte buffer[64];
+	arena region(buffer, sizeof(buffer));
+
+	void* p1 = region.allocate(3, 1);
+	void* p2 = region.allocate(8, 8);
+
+	EXPECT_EQ(p1, buffer);
+	EXPECT_EQ(p2, buffer + 8);
+	EXPECT_EQ(region.used(), 16);
+
+	EXPECT_THROW(region.allocate(64, 1), std::bad_alloc);
+
+	region.reset();
+
+	EXPECT_EQ(region.used(), 0);
+	EXPECT_EQ(region.allocate(64, 1), buffer);
+}
+
+TEST(arena_allocator, fixed_vector_from_arena)
+{
+	using fvector_int = fixed_vector<int, arena_allocator<int>>;
+
+	alignas(int) std::byte buffer[16 * sizeof(int)];
+	arena region(buffer, sizeof(buffer));
+
+	{
+		fvector_int vec1(4, region);
+		fvector_int vec2(8, region);
+
+		vec1.push_back(1);
+		vec2.push_back(2);
+
+		EXPECT_EQ(&vec1[0], reinterpret_cast<int*>(buffer));
+		EXPECT_EQ(&vec2[0], reinterpret_cast<int*>(buffer) + 4);
+
+		fvector_int vec3 = vec1;
+
+		EXPECT_EQ(vec3[0], 1);
+		EXPECT_EQ(region.used(), 16 * sizeof(int));
+	}
+
+	region.reset();
+
+	fvector_int vec(16, region);
+	EXPECT_EQ(vec.capacity(), 16);
+}
+
+}
@@ -0,0 +1,65 @@
+﻿#include <fv/concurrent_fixed_vector.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace concurrent_fixed_vector_test
+{
+
+TEST(concurrent_fixed_vector, push_back_and_overflow)
+{
+	concurrent_fixed_vector<int> vec(2);
+
+	EXPECT_TRUE(vec.push_back(1));
+	EXPECT_TRUE(vec.emplace_back(2));
+	EXPECT_FALSE(vec.push_back(3));
+
+	EXPECT_TRUE(vec.full());
+	EXPECT_EQ(vec.size(), 2u);
+	EXPECT_TRUE(vec.published(1));
+	EXPECT_EQ(vec.at(1), 2);
+
+	vec.clean();
+
+	EXPECT_TRUE(vec.empty());
+	EXPECT_FALSE(vec.published(0));
+}
+
+TEST(concurrent_fixed_vector, concurrent_append)
+{
+	constexpr int THREADS = 4;
+	constexpr int PER_THREAD = 10000;
+
+	concurrent_fixed_vector<int> vec(THREADS * PER_THREAD);
+
+	// gtest assertions are not thread-safe here, workers count their failures and the main thread checks them after join
+	std::vector<int> failed(THREADS, 0);
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < THREADS; ++t)
+	{
+		threads.emplace_back([&vec, &failed, t]{
+			for (int i = 0; i < PER_THREAD; ++i)
+				failed[t] += !vec.push_back(t * PER_THREAD + i);
+		});
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	for (int t = 0; t < THREADS; ++t)
+		EXPECT_EQ(failed[t], 0) << "thread " << t;
+
+	EXPECT_TRUE(vec.full());
+
+	std::vector<int> items(vec.begin(), vec.end());
+	std::sort(items.begin(), items.end());
+
+	for (int i = 0; i < THREADS * PER_THREAD; ++i)
+		EXPECT_EQ(items[i], i);
+}
+
+}
@@ -0,0 +1,164 @@
+﻿#include <fv/fixed_ring.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace fixed_ring_test
+{
+
+TEST(fixed_ring, push_pop_wraps_around)
+{
+	fixed_ring<std::string> ring(4);
+
+	EXPECT_EQ(ring.capacity(), 4);
+	EXPECT_TRUE(ring.empty());
+
+	for (int round = 0; round < 3; ++round)
+	{
+		ring.push_back("a");
+		ring.emplace_back(2, 'b');
+		ring.push_back("c");
+
+		EXPECT_EQ(ring.size(), 3);
+		EXPECT_EQ(ring.front(), "a");
+		EXPECT_EQ(ring.back(), "c");
+		EXPECT_EQ(ring[1], "bb");
+
+		ring.pop_front();
+		ring.pop_front();
+
+		EXPECT_EQ(ring.front(), "c");
+
+		ring.pop_front();
+	}
+
+	ring.push_back("x");
+	ring.push_back("y");
+
+	fixed_ring<std::string> copy = ring;
+	ring.clean();
+
+	EXPECT_TRUE(ring.empty());
+	EXPECT_EQ(copy.size(), 2);
+	EXPECT_EQ(copy.front(), "x");
+}
+
+TEST(fixed_ring, full)
+{
+	fixed_ring<int> ring(2);
+
+	ring.push_back(1);
+	ring.push_back(2);
+
+	EXPECT_TRUE(ring.full());
+
+	ring.pop_front();
+	ring.push_back(3);
+
+	EXPECT_EQ(ring[0], 2);
+	EXPECT_EQ(ring[1], 3);
+}
+
+TEST(spsc_fixed_ring, single_thread)
+{
+	spsc_fixed_ring<int> ring(2);
+
+	EXPECT_TRUE(ring.try_push(1));
+	EXPECT_TRUE(ring.try_emplace(2));
+	EXPECT_FALSE(ring.try_push(3));
+
+	int item = 0;
+	EXPECT_TRUE(ring.try_pop(item));
+	EXPECT_EQ(item, 1);
+	EXPECT_EQ(*ring.front(), 2);
+
+	ring.pop();
+
+	EXPECT_EQ(ring.front(), nullptr);
+	EXPECT_FALSE(ring.try_pop(item));
+}
+
+TEST(spsc_fixed_ring, producer_consumer)
+{
+	constexpr int COUNT = 10000;
+
+	spsc_fixed_ring<int> ring(64);
+
+	std::thread producer([&ring]{
+		for (int i = 0; i < COUNT; ++i)
+		{
+			while (!ring.try_push(i))
+				std::this_thread::yield();
+		}
+	});
+
+	long long sum = 0;
+	int expected = 0;
+	for (int received = 0; received < COUNT;)
+	{
+		int item = 0;
+		if (ring.try_pop(item))
+		{
+			EXPECT_EQ(item, expected++);
+			sum += item;
+			++received;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	producer.join();
+
+	EXPECT_EQ(sum, (long long)COUNT * (COUNT - 1) / 2);
+	EXPECT_TRUE(ring.empty());
+}
+
+TEST(spsc_fixed_ring, size_from_monitor_thread)
+{
+	constexpr int COUNT = 20000;
+
+	spsc_fixed_ring<int> ring(16);
+	std::atomic<bool> done = false;
+
+	std::thread producer([&ring]{
+		for (int i = 0; i < COUNT; ++i)
+		{
+			while (!ring.try_push(i))
+				std::this_thread::yield();
+		}
+	});
+
+	std::thread consumer([&ring, &done]{
+		for (int received = 0; received < COUNT;)
+		{
+			int item = 0;
+			if (ring.try_pop(item))
+				++received;
+			else
+				std::this_thread::yield();
+		}
+		done = true;
+	});
+
+	// neither side: both counters move between the loads
+	spsc_fixed_ring<int>::size_type max_size = 0;
+	while (!done)
+	{
+		max_size = std::max(max_size, ring.size());
+		std::this_thread::yield();
+	}
+
+	producer.join();
+	consumer.join();
+
+	EXPECT_LE(max_size, ring.capacity());
+	EXPECT_TRUE(ring.empty());
+}
+
+}
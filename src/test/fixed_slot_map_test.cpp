@@ -0,0 +1,76 @@
+﻿#include <fv/fixed_slot_map.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace fixed_slot_map_test
+{
+
+TEST(fixed_slot_map, insert_and_find)
+{
+	fixed_slot_map<std::string> map(4);
+
+	slot_handle h1 = map.insert("one");
+	slot_handle h2 = map.emplace(3, 'x');
+
+	EXPECT_EQ(map.size(), 2);
+	EXPECT_TRUE(map.contains(h1));
+	EXPECT_EQ(map.at(h1), "one");
+	EXPECT_EQ(*map.find(h2), "xxx");
+	EXPECT_EQ(map.find(slot_handle{}), nullptr);
+}
+
+TEST(fixed_slot_map, erase_keeps_other_handles)
+{
+	fixed_slot_map<int> map(4);
+
+	slot_handle h1 = map.insert(1);
+	slot_handle h2 = map.insert(2);
+	slot_handle h3 = map.insert(3);
+
+	EXPECT_TRUE(map.erase(h1));
+	EXPECT_FALSE(map.erase(h1));
+
+	EXPECT_FALSE(map.contains(h1));
+	EXPECT_EQ(map.at(h2), 2);
+	EXPECT_EQ(map.at(h3), 3);
+	EXPECT_EQ(map.handle_of(0), h3);
+
+	// freed slot is reused with a new generation
+	slot_handle h4 = map.insert(4);
+
+	EXPECT_EQ(h4.index, h1.index);
+	EXPECT_NE(h4, h1);
+	EXPECT_EQ(map.find(h1), nullptr);
+	EXPECT_EQ(map.at(h4), 4);
+
+	int sum = 0;
+	for (int v : map)
+		sum += v;
+
+	EXPECT_EQ(sum, 9);
+}
+
+TEST(fixed_slot_map, clean_invalidates_handles)
+{
+	fixed_slot_map<int> map(2);
+
+	slot_handle h1 = map.insert(1);
+	slot_handle h2 = map.insert(2);
+
+	EXPECT_TRUE(map.full());
+
+	map.clean();
+
+	EXPECT_TRUE(map.empty());
+	EXPECT_FALSE(map.contains(h1));
+	EXPECT_FALSE(map.contains(h2));
+
+	slot_handle h3 = map.insert(3);
+	map.insert(4);
+
+	EXPECT_EQ(map.at(h3), 3);
+}
+
+}
@@ -2,6 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include <list>
+#include <stdexcept>
+#include <string>
+
 namespace fixed_vector_test
 {
 
@@ -192,4 +196,279 @@ TEST(fixed_vector, iterators)
 	EXPECT_EQ(sum, 6);
 }
 
+struct Mok2
+{
+	static inline int moves = 0;
+
+	std::unique_ptr<int> p;
+
+	Mok2(int v) : p(std::make_unique<int>(v)) {}
+	Mok2(Mok2&& other) noexcept : p(std::move(other.p)) { ++moves; }
+};
+
+}
+
+template<>
+struct is_trivially_relocatable<fixed_vector_test::Mok2> : std::true_type {};
+
+namespace fixed_vector_test
+{
+
+TEST(fixed_vector, trivially_relocatable_move_assignment)
+{
+	using fvector_Mok2 = fixed_vector<Mok2>;
+
+	fvector_Mok2 vec1(3);
+	vec1.emplace_back(1);
+	vec1.emplace_back(2);
+
+	fvector_Mok2 vec2(5);
+	Mok2::moves = 0;
+	vec2 = std::move(vec1);
+
+	EXPECT_EQ(Mok2::moves, 0);
+	EXPECT_EQ(vec1.capacity(), 0);
+	EXPECT_EQ(vec2.size(), 2);
+	EXPECT_EQ(*vec2[0].p, 1);
+	EXPECT_EQ(*vec2[1].p, 2);
+}
+
+TEST(fixed_vector, copy_assignment_to_smaller_vector)
+{
+	using fvector_int = fixed_vector<int>;
+
+	fvector_int vec1(5);
+	for (int i = 0; i < 5; ++i)
+		vec1.push_back(i);
+
+	fvector_int vec2(2);
+	vec2.push_back(10);
+	vec2 = vec1;
+
+	EXPECT_EQ(vec2.capacity(), 5);
+	EXPECT_EQ(vec2.size(), 5);
+	EXPECT_EQ(vec2[4], 4);
+}
+
+TEST(fixed_vector, bulk_append_and_assign)
+{
+	using fvector_int = fixed_vector<int>;
+
+	fvector_int vec(10);
+
+	const int items[] = { 1, 2, 3 };
+	vec.insert_back(items);
+	vec.push_back_n(2, 7);
+	vec.append_range(std::list<int>{ 8, 9 });
+
+	EXPECT_EQ(vec.size(), 7);
+	EXPECT_EQ(vec[2], 3);
+	EXPECT_EQ(vec[4], 7);
+	EXPECT_EQ(vec[6], 9);
+
+	const std::list<int> source = { 4, 5 };
+	vec.assign(source.begin(), source.end());
+
+	EXPECT_EQ(vec.size(), 2);
+	EXPECT_EQ(vec[0], 4);
+	EXPECT_EQ(vec[1], 5);
+}
+
+TEST(fixed_vector, write_in_place)
+{
+	using fvector_int = fixed_vector<int>;
+
+	fvector_int vec(8);
+	vec.push_back(1);
+
+	std::span<int> slots = vec.append_default_init(3);
+
+	EXPECT_EQ(slots.size(), 3);
+	EXPECT_EQ(slots.data(), &vec[1]);
+
+	for (int& slot : slots)
+		slot = 5;
+
+	EXPECT_EQ(vec.size(), 4);
+	EXPECT_EQ(vec[3], 5);
+
+	EXPECT_EQ(vec.resize_uninitialized(6).size(), 2);
+	EXPECT_EQ(vec.size(), 6);
+
+	EXPECT_TRUE(vec.resize_uninitialized(2).empty());
+	EXPECT_EQ(vec.size(), 2);
+	EXPECT_EQ(vec[1], 5);
+}
+
+TEST(fixed_vector, erase_keeps_order)
+{
+	using fvector_int = fixed_vector<int>;
+
+	fvector_int vec(10);
+	for (int i = 0; i < 8; ++i)
+		vec.push_back(i);
+
+	vec.erase(1); // 0 2 3 4 5 6 7
+	vec.erase(2, 4); // 0 2 5 6 7
+
+	EXPECT_EQ(vec.size(), 5);
+	EXPECT_EQ(vec[0], 0);
+	EXPECT_EQ(vec[1], 2);
+	EXPECT_EQ(vec[2], 5);
+	EXPECT_EQ(vec[4], 7);
+
+	const fvector_int::size_type indices[] = { 0, 2, 4 };
+	vec.erase_indices(indices); // 2 6
+
+	EXPECT_EQ(vec.size(), 2);
+	EXPECT_EQ(vec[0], 2);
+	EXPECT_EQ(vec[1], 6);
+}
+
+TEST(fixed_vector, erase_non_trivial_items)
+{
+	fixed_vector<std::string> vec(6);
+	for (const char* s : { "a", "b", "c", "d", "e", "f" })
+		vec.emplace_back(s);
+
+	vec.erase(0, 2); // c d e f
+	EXPECT_EQ(vec.size(), 4);
+	EXPECT_EQ(vec[0], "c");
+
+	const uint32_t indices[] = { 1, 3 };
+	vec.erase_indices(indices); // c e
+
+	EXPECT_EQ(vec.size(), 2);
+	EXPECT_EQ(vec[0], "c");
+	EXPECT_EQ(vec[1], "e");
+}
+
+TEST(fixed_vector, erase_trivially_relocatable_items)
+{
+	fixed_vector<Mok2> vec(5);
+	for (int i = 0; i < 5; ++i)
+		vec.emplace_back(i);
+
+	Mok2::moves = 0;
+	vec.erase(1);
+
+	const uint32_t indices[] = { 0, 3 };
+	vec.erase_indices(indices); // 2 3
+
+	EXPECT_EQ(Mok2::moves, 0);
+	EXPECT_EQ(vec.size(), 2);
+	EXPECT_EQ(*vec[0].p, 2);
+	EXPECT_EQ(*vec[1].p, 3);
+}
+
+TEST(fixed_vector, try_push_back)
+{
+	fixed_vector<std::string> vec(2);
+
+	EXPECT_TRUE(vec.try_push_back("a"));
+	std::string b = "b";
+	EXPECT_TRUE(vec.try_push_back(b));
+	EXPECT_FALSE(vec.try_emplace_back(3, 'c'));
+
+	EXPECT_EQ(vec.size(), 2);
+	EXPECT_EQ(vec[1], "b");
+}
+
+TEST(fixed_vector, overflow_policies)
+{
+	fixed_vector<int, default_allocator<int>, overflow_throw> throwing(1);
+	throwing.push_back(1);
+	EXPECT_THROW(throwing.push_back(2), std::length_error);
+	EXPECT_EQ(throwing.size(), 1);
+
+	fixed_vector<int, default_allocator<int>, overflow_drop_newest> dropping(2);
+	for (int i = 0; i < 4; ++i)
+		dropping.push_back(i);
+	EXPECT_EQ(dropping.size(), 2);
+	EXPECT_EQ(dropping[1], 1);
+
+	fixed_vector<int, default_allocator<int>, overflow_overwrite_oldest> overwriting(3);
+	for (int i = 0; i < 5; ++i)
+		overwriting.emplace_back(i);
+	overwriting.push_back(overwriting[0]);
+	EXPECT_EQ(overwriting.size(), 3);
+	EXPECT_EQ(overwriting[0], 3);
+	EXPECT_EQ(overwriting[1], 4);
+	EXPECT_EQ(overwriting[2], 2);
+
+	fixed_vector<std::string, default_allocator<std::string>, overflow_spill> spilling(1);
+	spilling.push_back("a");
+	spilling.push_back("b");
+	spilling.emplace_back(2, 'c');
+	EXPECT_EQ(spilling.size(), 1);
+	ASSERT_EQ(spilling.spilled().size(), 2);
+	EXPECT_EQ(spilling.spilled()[1], "cc");
+
+	auto copy = spilling;
+	EXPECT_EQ(copy.spilled().size(), 2);
+
+	spilling.clean();
+	EXPECT_TRUE(spilling.spilled().empty());
+	EXPECT_EQ(copy.spilled()[0], "b");
+}
+
+TEST(inline_fixed_vector, ctor_and_sizes)
+{
+	using ivector_int = inline_fixed_vector<int, 10>;
+
+	ivector_int vec;
+
+	EXPECT_EQ(vec.size(), 0);
+	EXPECT_EQ(vec.capacity(), 10);
+	EXPECT_TRUE(vec.empty());
+	EXPECT_FALSE(vec.full());
+	EXPECT_GE(sizeof(ivector_int), 10 * sizeof(int));
+}
+
+TEST(inline_fixed_vector, push_back_emplace_back_and_remove)
+{
+	inline_fixed_vector<Mok1, 3> vec;
+
+	vec.push_back(Mok1(1, 2));
+	vec.emplace_back(3, 4);
+	vec.emplace_back(5, 6);
+
+	EXPECT_TRUE(vec.full());
+	EXPECT_EQ(vec.at(1).x, 3);
+
+	vec.remove(0);
+
+	EXPECT_EQ(vec.size(), 2);
+	EXPECT_EQ(vec[0].x, 5);
+	EXPECT_EQ(vec[1].x, 3);
+}
+
+TEST(inline_fixed_vector, copy_and_move)
+{
+	using ivector_int = inline_fixed_vector<int, 4>;
+
+	ivector_int vec1;
+	vec1.push_back(1);
+	vec1.push_back(2);
+
+	ivector_int vec2 = vec1;
+
+	EXPECT_EQ(vec2.size(), 2);
+	EXPECT_EQ(vec2[1], 2);
+
+	ivector_int vec3;
+	vec3.push_back(9);
+	vec3 = std::move(vec1);
+
+	EXPECT_TRUE(vec1.empty());
+	EXPECT_EQ(vec3.size(), 2);
+	EXPECT_EQ(vec3[0], 1);
+
+	int sum = 0;
+	for (int v : vec3)
+		sum += v;
+
+	EXPECT_EQ(sum, 3);
+}
+
 }
\ No newline at end of file
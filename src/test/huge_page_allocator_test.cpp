@@ -0,0 +1,42 @@
+﻿#include <fv/huge_page_allocator.hpp>
+
+#include <gtest/gtest.h>
+
+namespace huge_page_allocator_test
+{
+
+template<huge_page_mode mode>
+void fill_and_check()
+{
+	using fvector_int = fixed_vector<int, huge_page_allocator<int, mode>>;
+
+	// a bit more than one huge page
+	fvector_int vec(600 * 1024);
+
+	for (int i = 0; i < 600 * 1024; ++i)
+		vec.push_back(i);
+
+	EXPECT_TRUE(vec.full());
+	EXPECT_EQ(vec[600 * 1024 - 1], 600 * 1024 - 1);
+
+#if defined(__linux__)
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(vec.begin()) % fv_detail::huge_page_size, 0);
+#endif
+}
+
+TEST(huge_page_allocator, lazy)
+{
+	fill_and_check<huge_page_mode::lazy>();
+}
+
+TEST(huge_page_allocator, prefault)
+{
+	fill_and_check<huge_page_mode::prefault>();
+}
+
+TEST(huge_page_allocator, lock)
+{
+	fill_and_check<huge_page_mode::lock>();
+}
+
+}
@@ -0,0 +1,131 @@
+﻿#include <fv/mapped_fixed_vector.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+namespace mapped_fixed_vector_test
+{
+
+struct entry
+{
+	uint64_t key;
+	double value;
+};
+
+class mapped_fixed_vector_file : public ::testing::Test
+{
+protected:
+	std::filesystem::path path = std::filesystem::temp_directory_path() / ("mapped_fixed_vector_test_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+
+	void TearDown() override
+	{
+		std::filesystem::remove(path);
+	}
+};
+
+TEST_F(mapped_fixed_vector_file, append_and_reopen)
+{
+	{
+		auto vec = mapped_fixed_vector<entry>::create(path, 100);
+
+		EXPECT_TRUE(vec.empty());
+		EXPECT_TRUE(vec.writable());
+		EXPECT_EQ(vec.capacity(), 100u);
+
+		for (uint64_t i = 0; i < 10; ++i)
+			vec.push_back({ i, i * 0.5 });
+
+		const std::vector<entry> more = { { 100, 1.0 }, { 101, 2.0 } };
+		vec.insert_back(more);
+		vec.emplace_back(entry{ 200, 3.0 });
+		vec.remove(0);
+
+		EXPECT_EQ(vec.size(), 12u);
+		EXPECT_TRUE(vec.flush());
+	}
+
+	const auto snapshot = mapped_fixed_vector<entry>::open(path);
+
+	EXPECT_FALSE(snapshot.writable());
+	ASSERT_EQ(snapshot.size(), 12u);
+	EXPECT_EQ(snapshot.capacity(), 100u);
+	EXPECT_EQ(snapshot[0].key, 200u);
+	EXPECT_EQ(snapshot.at(1).key, 1u);
+	EXPECT_EQ(snapshot[11].value, 2.0);
+
+	uint64_t key_sum = 0;
+	for (const entry& e : snapshot)
+		key_sum += e.key;
+	EXPECT_EQ(key_sum, 200u + 45u + 100u + 101u);
+}
+
+TEST_F(mapped_fixed_vector_file, reopen_writable_and_move)
+{
+	{
+		auto vec = mapped_fixed_vector<uint32_t>::create(path, 4);
+		vec.push_back(1);
+	}
+
+	auto vec = mapped_fixed_vector<uint32_t>::open(path, true);
+	vec.push_back(2);
+	vec[0] = 10;
+
+	mapped_fixed_vector<uint32_t> moved = std::move(vec);
+	EXPECT_EQ(vec.size(), 0u);
+	EXPECT_EQ(moved.size(), 2u);
+
+	moved.clean();
+	EXPECT_TRUE(moved.empty());
+	moved.push_back(7);
+	moved = mapped_fixed_vector<uint32_t>::open(path);
+
+	ASSERT_EQ(moved.size(), 1u);
+	EXPECT_EQ(moved[0], 7u);
+}
+
+TEST_F(mapped_fixed_vector_file, read_only_is_copy_on_write)
+{
+	{
+		auto vec = mapped_fixed_vector<uint32_t>::create(path, 4);
+		vec.push_back(1);
+		vec.push_back(2);
+	}
+
+	{
+		auto reader = mapped_fixed_vector<uint32_t>::open(path);
+		reader[0] = 10;
+		for (uint32_t& item : reader)
+			item += 1;
+
+		EXPECT_EQ(reader[0], 11u);
+		EXPECT_EQ(reader[1], 3u);
+	}
+
+	const auto snapshot = mapped_fixed_vector<uint32_t>::open(path);
+	EXPECT_EQ(snapshot[0], 1u);
+	EXPECT_EQ(snapshot[1], 2u);
+}
+
+TEST_F(mapped_fixed_vector_file, rejects_foreign_files)
+{
+	EXPECT_THROW(mapped_fixed_vector<uint32_t>::open(path), std::system_error);
+
+	{
+		auto vec = mapped_fixed_vector<uint32_t>::create(path, 4);
+	}
+	EXPECT_THROW(mapped_fixed_vector<uint64_t>::open(path), std::runtime_error);
+
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file << "definitely not a fixed_vector snapshot, but long enough";
+	}
+	EXPECT_THROW(mapped_fixed_vector<uint32_t>::open(path), std::runtime_error);
+}
+
+}
@@ -0,0 +1,50 @@
+﻿#include <fv/numa_allocator.hpp>
+
+#include <gtest/gtest.h>
+
+namespace numa_allocator_test
+{
+
+TEST(numa_allocator, online_nodes)
+{
+	EXPECT_TRUE(fv_detail::numa_online_nodes() & 1);
+}
+
+TEST(numa_allocator, interleave_and_bind)
+{
+	fixed_vector<int, numa_allocator<int, numa_policy::interleave>> interleaved(1 << 20);
+	fixed_vector<int, numa_allocator<int, numa_policy::bind>> bound(1 << 20, numa_allocator<int, numa_policy::bind>(0));
+
+	for (int i = 0; i < 1 << 20; ++i)
+	{
+		interleaved.push_back(i);
+		bound.push_back(i);
+	}
+
+	EXPECT_EQ(interleaved[12345], 12345);
+	EXPECT_EQ(bound[54321], 54321);
+}
+
+TEST(numa_allocator, parallel_first_touch)
+{
+	using fvector_int = fixed_vector<int, numa_allocator<int>>;
+
+	fvector_int vec(1 << 20);
+	parallel_first_touch(vec, 4);
+
+	EXPECT_TRUE(vec.empty());
+
+	for (int i = 0; i < 1 << 20; ++i)
+		vec.push_back(i);
+
+	EXPECT_EQ(vec[(1 << 20) - 1], (1 << 20) - 1);
+
+	// chunks may be touched one by one, also with the default allocator
+	fixed_vector<double> plain(1000);
+	for (uint32_t chunk = 0; chunk < 3; ++chunk)
+		first_touch(plain, chunk, 3);
+
+	EXPECT_TRUE(plain.empty());
+}
+
+}
@@ -0,0 +1,131 @@
+﻿#include <fv/parallel.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace parallel_test
+{
+
+TEST(thread_pool, runs_every_index_once)
+{
+	constexpr uint32_t COUNT = 10000;
+
+	thread_pool pool(4);
+	EXPECT_EQ(pool.thread_count(), 4u);
+
+	std::vector<std::atomic<int>> hits(COUNT);
+	pool.run(COUNT, [&](uint32_t i) { hits[i].fetch_add(1); });
+
+	for (uint32_t i = 0; i < COUNT; ++i)
+		ASSERT_EQ(hits[i].load(), 1) << "index " << i;
+
+	// nested jobs run on the calling thread
+	std::atomic<int> nested = 0;
+	pool.run(8, [&](uint32_t) { pool.run(8, [&](uint32_t) { nested.fetch_add(1); }); });
+	EXPECT_EQ(nested.load(), 64);
+}
+
+TEST(thread_pool, rethrows_exception)
+{
+	thread_pool pool(3);
+	std::atomic<int> done = 0;
+
+	EXPECT_THROW(pool.run(100, [&](uint32_t i) {
+		if (i == 42)
+			throw std::runtime_error("fail");
+		done.fetch_add(1);
+	}), std::runtime_error);
+
+	EXPECT_EQ(done.load(), 99);
+}
+
+TEST(thread_pool, rethrows_exception_inline)
+{
+	// without workers the job runs on the calling thread, the remaining indices still run before the rethrow
+	thread_pool pool(1);
+	int done = 0;
+
+	EXPECT_THROW(pool.run(100, [&](uint32_t i) {
+		if (i == 42 || i == 43)
+			throw std::runtime_error(i == 42 ? "first" : "second");
+		++done;
+	}), std::runtime_error);
+
+	EXPECT_EQ(done, 98);
+
+	std::string message;
+	try
+	{
+		pool.run(3, [](uint32_t i) { throw std::runtime_error(i == 0 ? "first" : "later"); });
+	}
+	catch (const std::runtime_error& e)
+	{
+		message = e.what();
+	}
+	EXPECT_EQ(message, "first");
+}
+
+TEST(parallel, for_each_and_transform)
+{
+	constexpr uint32_t COUNT = 100000;
+
+	thread_pool pool(4);
+
+	fixed_vector<uint32_t> vec(COUNT);
+	vec.resize_uninitialized(COUNT);
+	std::iota(vec.begin(), vec.end(), 0u);
+
+	parallel_for_each(vec, [](uint32_t& item) { item *= 2; }, 1000, pool);
+
+	fixed_vector<uint64_t> squares(COUNT);
+	parallel_transform(vec, squares, [](uint32_t item) { return uint64_t(item) * item; }, 0, pool);
+
+	ASSERT_EQ(squares.size(), COUNT);
+	for (uint32_t i = 0; i < COUNT; ++i)
+	{
+		ASSERT_EQ(vec[i], 2 * i);
+		ASSERT_EQ(squares[i], uint64_t(2 * i) * (2 * i));
+	}
+}
+
+TEST(parallel, reduce_and_count_if)
+{
+	constexpr uint32_t COUNT = 100001;
+
+	fixed_vector<uint32_t> vec(COUNT);
+	vec.resize_uninitialized(COUNT);
+	std::iota(vec.begin(), vec.end(), 1u);
+
+	thread_pool pool(4);
+
+	EXPECT_EQ(parallel_reduce(vec, uint64_t(0), std::plus<>{}, 100, pool), uint64_t(COUNT) * (COUNT + 1) / 2);
+	EXPECT_EQ(parallel_reduce(vec, uint32_t(0), [](uint32_t a, uint32_t b) { return std::max(a, b); }, 0, pool), COUNT);
+	EXPECT_EQ(parallel_count_if(vec, [](uint32_t item) { return item % 3 == 0; }, 777, pool), COUNT / 3);
+
+	fixed_vector<uint32_t> empty(1);
+	EXPECT_EQ(parallel_reduce(empty, uint64_t(5), std::plus<>{}, 0, pool), 5u);
+}
+
+TEST(parallel, reduce_order_is_deterministic)
+{
+	constexpr uint32_t COUNT = 50000;
+
+	fixed_vector<float> vec(COUNT);
+	for (uint32_t i = 0; i < COUNT; ++i)
+		vec.push_back(1.0f / float(i + 1));
+
+	thread_pool one(1);
+	thread_pool many(4);
+
+	const float expected = parallel_reduce(vec, 0.0f, std::plus<>{}, 500, one);
+	for (int run = 0; run < 10; ++run)
+		ASSERT_EQ(parallel_reduce(vec, 0.0f, std::plus<>{}, 500, many), expected);
+}
+
+}
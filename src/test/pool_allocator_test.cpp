@@ -0,0 +1,50 @@
+﻿#include <fv/pool_allocator.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace pool_allocator_test
+{
+
+TEST(pool_allocator, recycles_same_capacity)
+{
+	using fvector_int = fixed_vector<int, pool_allocator<int>>;
+
+	const int* released = nullptr;
+	{
+		fvector_int vec(256);
+		vec.push_back(1);
+		released = &vec[0];
+	}
+
+	fvector_int other_capacity(128);
+	fvector_int same_capacity(256);
+
+	EXPECT_NE(other_capacity.begin(), released);
+	EXPECT_EQ(same_capacity.begin(), released);
+}
+
+TEST(pool_allocator, shared_tier_crosses_threads)
+{
+	using allocator = pool_allocator<int, pool_sharing::shared_fallback>;
+
+	allocator al;
+	int* blocks[fv_detail::pool_thread_cache::max_blocks_per_size + 1];
+
+	for (int*& p : blocks)
+		p = al.allocate(1000);
+
+	// the last block overflows the thread cache and goes to the shared tier
+	for (int* p : blocks)
+		al.deallocate(p, 1000);
+
+	int* taken = nullptr;
+	std::thread([&]{ taken = al.allocate(1000); }).join();
+
+	EXPECT_EQ(taken, blocks[fv_detail::pool_thread_cache::max_blocks_per_size]);
+
+	al.deallocate(taken, 1000);
+}
+
+}
@@ -0,0 +1,186 @@
+﻿#include <fv/serialize.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace serialize_test
+{
+
+constexpr column_codec all_codecs[] = {
+	column_codec::raw,
+	column_codec::varint,
+	column_codec::delta_varint,
+	column_codec::bit_packed,
+	column_codec::delta_bit_packed,
+};
+
+template<class T, class allocator_t>
+std::vector<std::byte> to_bytes(const fixed_vector<T, allocator_t>& vec, column_codec codec)
+{
+	std::vector<std::byte> bytes;
+	serialize(vec, [&](std::span<const std::byte> chunk) { bytes.insert(bytes.end(), chunk.begin(), chunk.end()); }, codec);
+	return bytes;
+}
+
+template<class T, class allocator_t>
+std::vector<std::byte> to_bytes(const fixed_vector<T, allocator_t>& vec)
+{
+	std::vector<std::byte> bytes;
+	serialize(vec, [&](std::span<const std::byte> chunk) { bytes.insert(bytes.end(), chunk.begin(), chunk.end()); });
+	return bytes;
+}
+
+template<class vector_t>
+concept accepts_codec = requires(const vector_t& vec, void (*sink)(std::span<const std::byte>)) { serialize(vec, sink, column_codec::varint); };
+
+static_assert(accepts_codec<fixed_vector<int>>);
+static_assert(!accepts_codec<fixed_vector<bool>>);
+static_assert(!accepts_codec<fixed_vector<float>>);
+
+template<class T>
+class serialize_typed : public ::testing::Test {};
+
+using integral_types = ::testing::Types<uint8_t, int16_t, uint32_t, int32_t, uint64_t, int64_t>;
+TYPED_TEST_SUITE(serialize_typed, integral_types);
+
+TYPED_TEST(serialize_typed, round_trip_every_codec)
+{
+	constexpr uint32_t COUNT = 1000;
+
+	std::mt19937_64 random(3);
+
+	fixed_vector<TypeParam> vec(COUNT);
+	vec.push_back(std::numeric_limits<TypeParam>::min());
+	vec.push_back(std::numeric_limits<TypeParam>::max());
+	while (!vec.full())
+		vec.push_back(static_cast<TypeParam>(random()));
+
+	for (column_codec codec : all_codecs)
+	{
+		const std::vector<std::byte> bytes = to_bytes(vec, codec);
+
+		fixed_vector<TypeParam> decoded(COUNT);
+		EXPECT_EQ(deserialize(bytes, decoded), bytes.size());
+
+		ASSERT_EQ(decoded.size(), vec.size()) << "codec " << int(codec);
+		EXPECT_TRUE(std::equal(vec.begin(), vec.end(), decoded.begin())) << "codec " << int(codec);
+	}
+}
+
+TEST(serialize, sorted_ids_compress)
+{
+	constexpr uint32_t COUNT = 10000;
+
+	fixed_vector<uint32_t> ids(COUNT);
+	for (uint32_t i = 0; i < COUNT; ++i)
+		ids.push_back(1000000 + i * 3 + (i % 7));
+
+	const std::size_t raw = to_bytes(ids, column_codec::raw).size();
+	const std::size_t varint = to_bytes(ids, column_codec::delta_varint).size();
+	const std::size_t packed = to_bytes(ids, column_codec::delta_bit_packed).size();
+
+	EXPECT_LT(varint * 3, raw);
+	EXPECT_LT(packed * 6, raw);
+
+	const std::vector<std::byte> bytes = to_bytes(ids, column_codec::delta_bit_packed);
+	fixed_vector<uint32_t> decoded(COUNT);
+	deserialize(bytes, decoded);
+	EXPECT_TRUE(std::equal(ids.begin(), ids.end(), decoded.begin(), decoded.end()));
+}
+
+TEST(serialize, raw_structs_and_empty)
+{
+	struct point { float x, y; };
+
+	fixed_vector<point> points(3);
+	points.push_back({ 1.0f, 2.0f });
+	points.push_back({ 3.0f, 4.0f });
+
+	fixed_vector<point> decoded(3);
+	deserialize(to_bytes(points), decoded);
+	ASSERT_EQ(decoded.size(), 2u);
+	EXPECT_EQ(decoded[1].y, 4.0f);
+
+	fixed_vector<int> empty(1);
+	fixed_vector<int> decoded_empty(1);
+	decoded_empty.push_back(5);
+	deserialize(to_bytes(empty, column_codec::delta_bit_packed), decoded_empty);
+	EXPECT_TRUE(decoded_empty.empty());
+}
+
+TEST(serialize, item_size_over_one_byte)
+{
+	struct block_256 { uint8_t bytes[256]; };
+	struct block_257 { uint8_t bytes[257]; };
+
+	fixed_vector<block_256> blocks(2);
+	blocks.emplace_back();
+	blocks[0].bytes[255] = 7;
+
+	fixed_vector<block_256> decoded(2);
+	deserialize(to_bytes(blocks), decoded);
+	ASSERT_EQ(decoded.size(), 1u);
+	EXPECT_EQ(decoded[0].bytes[255], 7);
+
+	// one size byte held 256 as 0 and 257 as 1, the size is a varint now
+	fixed_vector<block_257> other(2);
+	EXPECT_THROW(deserialize(to_bytes(blocks), other), std::runtime_error);
+
+	other.emplace_back();
+	other[0].bytes[256] = 9;
+	fixed_vector<block_257> decoded_other(2);
+	deserialize(to_bytes(other), decoded_other);
+	ASSERT_EQ(decoded_other.size(), 1u);
+	EXPECT_EQ(decoded_other[0].bytes[256], 9);
+}
+
+TEST(serialize, validates_bool)
+{
+	fixed_vector<bool> flags(3);
+	flags.push_back(true);
+	flags.push_back(false);
+
+	std::vector<std::byte> bytes = to_bytes(flags);
+
+	fixed_vector<bool> decoded(3);
+	deserialize(bytes, decoded);
+	ASSERT_EQ(decoded.size(), 2u);
+	EXPECT_TRUE(decoded[0]);
+	EXPECT_FALSE(decoded[1]);
+
+	bytes.back() = std::byte(2);
+	EXPECT_THROW(deserialize(bytes, decoded), std::runtime_error);
+	EXPECT_TRUE(decoded.empty());
+}
+
+TEST(serialize, rejects_bad_input)
+{
+	fixed_vector<uint32_t> vec(4);
+	vec.push_back(1);
+	vec.push_back(300);
+	vec.push_back(70000);
+
+	const std::vector<std::byte> bytes = to_bytes(vec, column_codec::varint);
+
+	fixed_vector<uint32_t> small(2);
+	EXPECT_THROW(deserialize(bytes, small), std::length_error);
+
+	fixed_vector<uint64_t> wide(4);
+	EXPECT_THROW(deserialize(bytes, wide), std::runtime_error);
+
+	EXPECT_THROW(to_bytes(vec, column_codec(42)), std::invalid_argument);
+
+	fixed_vector<uint32_t> decoded(4);
+	decoded.push_back(9);
+	EXPECT_THROW(deserialize(std::span(bytes).first(bytes.size() - 1), decoded), std::runtime_error);
+	EXPECT_TRUE(decoded.empty());
+}
+
+}
@@ -0,0 +1,116 @@
+﻿#include <fv/shared_fixed_vector.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace shared_fixed_vector_test
+{
+
+struct quote
+{
+	uint64_t sequence;
+	double price;
+};
+
+class shared_fixed_vector_segment : public ::testing::Test
+{
+protected:
+	std::string name = "fv_test_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name());
+
+	void TearDown() override
+	{
+		shared_fixed_vector<quote>::unlink(name);
+	}
+};
+
+TEST_F(shared_fixed_vector_segment, reader_sees_published_items)
+{
+	auto writer = shared_fixed_vector<quote>::create(name, 16);
+	const auto reader = shared_fixed_vector<quote>::open(name);
+
+	EXPECT_TRUE(writer.writable());
+	EXPECT_FALSE(reader.writable());
+	EXPECT_EQ(reader.capacity(), 16u);
+	EXPECT_TRUE(reader.empty());
+
+	// same segment, mapped at another address
+	EXPECT_NE(static_cast<const void*>(reader.begin()), static_cast<const void*>(writer.begin()));
+
+	writer.push_back({ 1, 10.5 });
+	const std::vector<quote> more = { { 2, 11.0 }, { 3, 11.5 } };
+	writer.insert_back(more);
+
+	ASSERT_EQ(reader.size(), 3u);
+	EXPECT_EQ(reader[0].price, 10.5);
+	EXPECT_EQ(reader.at(2).sequence, 3u);
+	EXPECT_EQ(reader.items().back().price, 11.5);
+
+	writer.clean();
+	EXPECT_TRUE(reader.empty());
+}
+
+TEST_F(shared_fixed_vector_segment, concurrent_reader)
+{
+	constexpr uint32_t COUNT = 100000;
+
+	auto writer = shared_fixed_vector<quote>::create(name, COUNT);
+
+	std::thread reader_thread([&] {
+		const auto reader = shared_fixed_vector<quote>::open(name);
+
+		uint32_t seen = 0;
+		while (seen < COUNT)
+		{
+			const uint32_t size = reader.size();
+			for (; seen < size; ++seen)
+				ASSERT_EQ(reader[seen].sequence, seen);
+		}
+	});
+
+	for (uint32_t i = 0; i < COUNT; ++i)
+		writer.emplace_back(quote{ i, 1.0 });
+
+	reader_thread.join();
+	EXPECT_TRUE(writer.full());
+}
+
+TEST_F(shared_fixed_vector_segment, recreate_keeps_mapped_readers)
+{
+	auto writer = shared_fixed_vector<quote>::create(name, 4);
+	writer.push_back({ 1, 10.5 });
+	const auto reader = shared_fixed_vector<quote>::open(name);
+
+#if defined(_WIN32)
+	// the segment lives while the reader maps it, so it can't be replaced
+	EXPECT_THROW(shared_fixed_vector<quote>::create(name, 8), std::system_error);
+#else
+	// a restarted writer gets a fresh segment, the reader keeps its mapping of the old one intact
+	auto restarted = shared_fixed_vector<quote>::create(name, 8);
+	restarted.push_back({ 2, 20.5 });
+
+	ASSERT_EQ(reader.size(), 1u);
+	EXPECT_EQ(reader[0].sequence, 1u);
+	EXPECT_EQ(reader.capacity(), 4u);
+
+	const auto reopened = shared_fixed_vector<quote>::open(name);
+	EXPECT_EQ(reopened.capacity(), 8u);
+	ASSERT_EQ(reopened.size(), 1u);
+	EXPECT_EQ(reopened[0].sequence, 2u);
+#endif
+}
+
+TEST_F(shared_fixed_vector_segment, rejects_foreign_segments)
+{
+	EXPECT_THROW(shared_fixed_vector<quote>::open(name), std::system_error);
+
+	auto writer = shared_fixed_vector<quote>::create(name, 4);
+	EXPECT_THROW(shared_fixed_vector<uint32_t>::open(name), std::runtime_error);
+}
+
+}
@@ -0,0 +1,221 @@
+﻿#include <fv/fixed_vector.hpp>
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace simd_test
+{
+
+template<class T>
+class simd_kernels : public ::testing::Test {};
+
+using simd_types = ::testing::Types<int8_t, uint8_t, int16_t, uint16_t, int32_t, uint32_t, int64_t, uint64_t, float, double>;
+TYPED_TEST_SUITE(simd_kernels, simd_types);
+
+// every kernel the CPU supports must agree with the scalar one, for all sizes around the vector width
+TYPED_TEST(simd_kernels, match_scalar)
+{
+	using T = TypeParam;
+	namespace simd = fv_detail::simd;
+
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<int> dist(-100, 100);
+
+	for (uint32_t size : { 1u, 7u, 31u, 64u, 65u, 200u, 1000u })
+	{
+		std::vector<T> items(size);
+		for (T& item : items)
+			item = static_cast<T>(dist(rng));
+
+		// small integral values are summed exactly in any order, also as floating point
+		const std::vector<T> small = items;
+
+		items[size - 1] = std::numeric_limits<T>::max();
+		items[size / 2] = std::numeric_limits<T>::lowest();
+
+		const T needle = items[size * 3 / 4];
+		const T* first = items.data();
+
+		const T* found = simd::find_scalar(first, size, needle);
+		const uint32_t count = simd::count_scalar(first, size, needle);
+		const auto minmax = simd::minmax_scalar(first, size);
+		const auto sum = simd::sum_scalar(small.data(), size);
+
+		const simd::isa supported = simd::cpu_isa();
+
+		if (supported >= simd::isa::avx2)
+		{
+			EXPECT_EQ(simd::find_avx2(first, size, needle), found);
+			EXPECT_EQ(simd::find_avx2(first, size, T(111)), first + size);
+			EXPECT_EQ(simd::count_avx2(first, size, needle), count);
+			if constexpr (simd::avx2_has_minmax<T>)
+			{
+				EXPECT_EQ(simd::minmax_avx2(first, size), minmax);
+			}
+			if constexpr (simd::simd_has_sum<T>)
+			{
+				EXPECT_EQ(simd::sum_avx2(small.data(), size), sum);
+			}
+		}
+
+		if (supported >= simd::isa::avx512)
+		{
+			EXPECT_EQ(simd::find_avx512(first, size, needle), found);
+			EXPECT_EQ(simd::count_avx512(first, size, needle), count);
+			EXPECT_EQ(simd::minmax_avx512(first, size), minmax);
+			if constexpr (simd::simd_has_sum<T>)
+			{
+				EXPECT_EQ(simd::sum_avx512(small.data(), size), sum);
+			}
+		}
+	}
+}
+
+TEST(fixed_vector, search_and_reductions)
+{
+	fixed_vector<uint32_t> ids(100);
+	for (uint32_t i = 0; i < 100; ++i)
+		ids.push_back(i % 10);
+
+	EXPECT_EQ(ids.find(7), ids.begin() + 7);
+	EXPECT_EQ(ids.find(70), ids.end());
+	EXPECT_EQ(ids.count(3), 10u);
+	EXPECT_TRUE(ids.contains(9));
+	EXPECT_FALSE(ids.contains(10));
+	EXPECT_EQ(ids.min(), 0u);
+	EXPECT_EQ(ids.max(), 9u);
+	EXPECT_EQ(ids.sum(), 450u);
+
+	fixed_vector<float> values(3);
+	values.push_back(1.5f);
+	values.push_back(-2.0f);
+	values.push_back(4.0f);
+
+	EXPECT_EQ(values.minmax(), std::make_pair(-2.0f, 4.0f));
+	EXPECT_EQ(values.sum(), 3.5f);
+}
+
+TEST(fixed_vector, long_double_uses_scalar_kernels)
+{
+	static_assert(fv_detail::simd::simd_item<long double>);
+	static_assert(!fv_detail::simd::vector_item<long double>);
+
+	// enough items for several vector blocks, if a vector kernel was picked by mistake
+	fixed_vector<long double> values(40);
+	for (int i = 0; i < 40; ++i)
+		values.push_back(i + 0.5L);
+
+	EXPECT_EQ(values.find(3.5L), values.begin() + 3);
+	EXPECT_EQ(values.count(3.5L), 1u);
+	EXPECT_EQ(values.min(), 0.5L);
+	EXPECT_EQ(values.max(), 39.5L);
+	EXPECT_EQ(values.sum(), 800.0L);
+}
+
+
+template<class T>
+class simd_compress : public ::testing::Test {};
+
+using compress_types = ::testing::Types<int8_t, int32_t, uint32_t, int64_t, uint64_t, float, double>;
+TYPED_TEST_SUITE(simd_compress, compress_types);
+
+template<compare_op op, class T>
+void check_compress(const std::vector<T>& items, T value)
+{
+	namespace simd = fv_detail::simd;
+
+	std::vector<T> expected = items;
+	expected.resize(simd::compress_scalar(expected.data(), uint32_t(expected.size()), compare_with<op, T>{ value }));
+
+	auto check = [&](auto kernel) {
+		std::vector<T> actual = items;
+		actual.resize(kernel(actual.data(), uint32_t(actual.size()), value));
+		EXPECT_EQ(actual, expected);
+	};
+
+	if constexpr (simd::simd_has_compress<T>)
+	{
+		if (simd::cpu_isa() >= simd::isa::avx2)
+			check([](T* p, uint32_t n, T v) { return simd::compress_avx2<op>(p, n, v); });
+		if (simd::cpu_isa() >= simd::isa::avx512)
+			check([](T* p, uint32_t n, T v) { return simd::compress_avx512<op>(p, n, v); });
+	}
+	check([](T* p, uint32_t n, T v) { return simd::compress<op>(p, n, v); });
+}
+
+TYPED_TEST(simd_compress, match_scalar)
+{
+	using T = TypeParam;
+
+	std::mt19937 rng(7);
+	std::uniform_int_distribution<int> dist(0, 100);
+
+	for (uint32_t size : { 0u, 3u, 16u, 37u, 1000u })
+	{
+		std::vector<T> items(size);
+		for (T& item : items)
+			item = static_cast<T>(dist(rng));
+
+		check_compress<compare_op::equal>(items, T(50));
+		check_compress<compare_op::not_equal>(items, T(50));
+		check_compress<compare_op::less>(items, T(30));
+		check_compress<compare_op::less_equal>(items, T(30));
+		check_compress<compare_op::greater>(items, T(70));
+		check_compress<compare_op::greater_equal>(items, T(70));
+	}
+}
+
+TEST(fixed_vector, remove_if)
+{
+	fixed_vector<float> particles(100);
+	for (int i = 0; i < 100; ++i)
+		particles.push_back(float(i % 10));
+
+	EXPECT_EQ(particles.remove_if(compare_with<compare_op::less, float>{ 3.0f }), 30u);
+	EXPECT_EQ(particles.size(), 70u);
+	EXPECT_EQ(particles[0], 3.0f);
+	EXPECT_EQ(particles[7], 3.0f);
+
+	fixed_vector<std::string> names(5);
+	for (const char* name : { "a", "bb", "c", "dd", "e" })
+		names.emplace_back(name);
+
+	EXPECT_EQ(names.remove_if([](const std::string& s) { return s.size() == 2; }), 2u);
+	EXPECT_EQ(names.size(), 3u);
+	EXPECT_EQ(names[0], "a");
+	EXPECT_EQ(names[1], "c");
+	EXPECT_EQ(names[2], "e");
+}
+
+TEST(fixed_vector, remove_if_long_double)
+{
+	static_assert(!fv_detail::simd::simd_has_compress<long double>);
+
+	fixed_vector<long double> values(40);
+	for (int i = 0; i < 40; ++i)
+		values.push_back(i + 0.5L);
+
+	EXPECT_EQ(values.remove_if(compare_with<compare_op::less, long double>{ 10.0L }), 10u);
+	ASSERT_EQ(values.size(), 30u);
+	EXPECT_EQ(values[0], 10.5L);
+	EXPECT_EQ(values[29], 39.5L);
+}
+
+TEST(fixed_vector, remove_if_unordered)
+{
+	fixed_vector<int> vec(6);
+	for (int v : { 1, 2, 3, 4, 5, 6 })
+		vec.push_back(v);
+
+	EXPECT_EQ(vec.remove_if_unordered([](int v) { return v % 2 == 0; }), 3u);
+	EXPECT_EQ(vec.size(), 3u);
+	EXPECT_EQ(vec[0], 1);
+	EXPECT_EQ(vec[1], 5);
+	EXPECT_EQ(vec[2], 3);
+}
+
+}
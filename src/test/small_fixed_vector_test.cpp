@@ -0,0 +1,105 @@
+﻿#include <fv/small_fixed_vector.hpp>
+#include <fv/stats_allocator.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace small_fixed_vector_test
+{
+
+TEST(small_fixed_vector, spills_once)
+{
+	using allocator = stats_allocator<std::string>;
+	small_fixed_vector<std::string, 4, allocator> vec(64, allocator("small_test.spill"));
+	const container_stats& stats = vec.get_allocator().stats();
+
+	for (int i = 0; i < 4; ++i)
+		vec.push_back(std::to_string(i));
+
+	EXPECT_FALSE(vec.spilled());
+	EXPECT_EQ(stats.allocations.load(), 0u);
+
+	// the argument refers to an item which is relocated by the spill
+	vec.push_back(vec[0]);
+	EXPECT_TRUE(vec.spilled());
+	EXPECT_EQ(vec.size(), 5u);
+	EXPECT_EQ(vec[4], "0");
+
+	for (int i = 5; i < 64; ++i)
+		vec.emplace_back(std::to_string(i));
+
+	EXPECT_TRUE(vec.full());
+	EXPECT_EQ(vec[63], "63");
+
+	// the block is kept after clean, so refilling does not allocate
+	vec.clean();
+	for (int i = 0; i < 10; ++i)
+		vec.push_back(std::to_string(i));
+
+	EXPECT_EQ(stats.allocations.load(), 1u);
+	EXPECT_EQ(stats.live_bytes.load(), 64 * sizeof(std::string));
+}
+
+TEST(small_fixed_vector, full)
+{
+	small_fixed_vector<int, 2> vec(4);
+	for (int i = 0; i < 4; ++i)
+		vec.push_back(i);
+
+	EXPECT_THROW(vec.push_back(4), std::length_error);
+	EXPECT_EQ(vec.size(), 4u);
+	EXPECT_EQ(vec[3], 3);
+
+	// capacity within the inline storage never spills
+	small_fixed_vector<int, 4> small(2);
+	small.push_back(0);
+	small.push_back(1);
+	EXPECT_THROW(small.push_back(2), std::length_error);
+	EXPECT_FALSE(small.spilled());
+}
+
+TEST(small_fixed_vector, copy_and_move)
+{
+	small_fixed_vector<std::unique_ptr<int>, 2> moved_from(8);
+	moved_from.push_back(std::make_unique<int>(1));
+
+	small_fixed_vector<std::unique_ptr<int>, 2> inline_vec(std::move(moved_from));
+	EXPECT_FALSE(inline_vec.spilled());
+	EXPECT_EQ(*inline_vec[0], 1);
+	EXPECT_TRUE(moved_from.empty());
+
+	for (int i = 2; i <= 5; ++i)
+		inline_vec.push_back(std::make_unique<int>(i));
+
+	const int* first = inline_vec[0].get();
+	small_fixed_vector<std::unique_ptr<int>, 2> spilled_vec(std::move(inline_vec));
+	EXPECT_TRUE(spilled_vec.spilled());
+	EXPECT_EQ(spilled_vec[0].get(), first);
+	EXPECT_FALSE(inline_vec.spilled());
+	EXPECT_TRUE(inline_vec.empty());
+
+	small_fixed_vector<int, 4> vec(16);
+	for (int i = 0; i < 6; ++i)
+		vec.push_back(i);
+
+	vec.remove(1);
+	EXPECT_EQ(vec[1], 5);
+
+	small_fixed_vector<int, 4> small(3);
+	small.push_back(7);
+	small = vec;
+	EXPECT_EQ(small.capacity(), 16u);
+	EXPECT_TRUE(small.spilled());
+	EXPECT_TRUE(std::equal(small.begin(), small.end(), vec.begin(), vec.end()));
+
+	vec.remove(0);
+	vec.remove(0);
+	small_fixed_vector<int, 4> copy(vec);
+	EXPECT_FALSE(copy.spilled());
+	EXPECT_TRUE(std::equal(copy.rbegin(), copy.rend(), vec.rbegin(), vec.rend()));
+}
+
+}
@@ -0,0 +1,152 @@
+﻿#include <fv/soa_fixed_vector.hpp>
+#include <fv/arena_allocator.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace soa_fixed_vector_test
+{
+
+TEST(soa_fixed_vector, columns_are_contiguous)
+{
+	using soa_vector = soa_fixed_vector<float, uint8_t, double>;
+
+	soa_vector vec(4);
+
+	vec.push_back(1.0f, 1, 10.0);
+	vec.emplace_back(2.0f, 2, 20.0);
+	vec.emplace_back(3.0f, 3, 30.0);
+
+	EXPECT_EQ(vec.size(), 3);
+	EXPECT_EQ(vec.capacity(), 4);
+
+	std::span<double> column = vec.column<2>();
+
+	EXPECT_EQ(column.size(), 3);
+	EXPECT_EQ(&column[1], &column[0] + 1);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(column.data()) % alignof(double), 0);
+	EXPECT_EQ(column[2], 30.0);
+	EXPECT_EQ(vec.get<1>(1), 2);
+}
+
+TEST(soa_fixed_vector, remove_and_swap)
+{
+	soa_fixed_vector<int, std::string> vec(4);
+
+	vec.emplace_back(1, "one");
+	vec.emplace_back(2, "two");
+	vec.emplace_back(3, "three");
+
+	vec.remove(0);
+
+	EXPECT_EQ(vec.size(), 2);
+	EXPECT_EQ(vec.get<0>(0), 3);
+	EXPECT_EQ(vec.get<1>(0), "three");
+	EXPECT_EQ(vec.get<1>(1), "two");
+
+	vec.clean();
+
+	EXPECT_TRUE(vec.empty());
+}
+
+TEST(soa_fixed_vector, copy_and_move)
+{
+	using soa_vector = soa_fixed_vector<int, std::string>;
+
+	soa_vector vec1(2);
+	vec1.emplace_back(1, "one");
+
+	soa_vector vec2 = vec1;
+	EXPECT_EQ(vec2.get<1>(0), "one");
+
+	soa_vector vec3 = std::move(vec1);
+	EXPECT_EQ(vec1.capacity(), 0);
+	EXPECT_EQ(vec3.get<0>(0), 1);
+
+	vec3 = vec2;
+	vec2 = std::move(vec3);
+	EXPECT_EQ(vec2.size(), 1);
+	EXPECT_EQ(vec2.get<1>(0), "one");
+}
+
+struct counted
+{
+	static inline int alive = 0;
+
+	counted() { ++alive; }
+	counted(const counted&) { ++alive; }
+	~counted() { --alive; }
+};
+
+struct throws_on_copy
+{
+	static inline bool enabled = false;
+
+	throws_on_copy() = default;
+	throws_on_copy(const throws_on_copy&)
+	{
+		if (enabled)
+			throw std::runtime_error("copy");
+	}
+};
+
+TEST(soa_fixed_vector, throwing_copy)
+{
+	using soa_vector = soa_fixed_vector<counted, throws_on_copy>;
+
+	{
+		soa_vector vec(4);
+		vec.emplace_back(counted{}, throws_on_copy{});
+		vec.emplace_back(counted{}, throws_on_copy{});
+
+		soa_vector target(2);
+		target.emplace_back(counted{}, throws_on_copy{});
+		EXPECT_EQ(counted::alive, 3);
+
+		throws_on_copy::enabled = true;
+		EXPECT_THROW(soa_vector copy(vec), std::runtime_error);
+		EXPECT_THROW(target = vec, std::runtime_error);
+		throws_on_copy::enabled = false;
+
+		// the copied first column is rolled back, the assigned-to vector is untouched
+		EXPECT_EQ(counted::alive, 3);
+		EXPECT_EQ(target.size(), 1);
+		EXPECT_EQ(target.capacity(), 2);
+	}
+
+	EXPECT_EQ(counted::alive, 0);
+}
+
+TEST(soa_fixed_vector, columns_aligned_in_unaligned_block)
+{
+	using soa_vector = basic_soa_fixed_vector<arena_allocator<std::byte>, uint8_t, double>;
+
+	alignas(double) std::byte buffer[256];
+	arena region(buffer, sizeof(buffer));
+
+	// leave the arena at an odd offset, arena_allocator<std::byte> aligns to 1
+	region.allocate(1, 1);
+
+	soa_vector vec(4, region);
+	vec.emplace_back(uint8_t(1), 1.5);
+
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(vec.column<1>().data()) % alignof(double), 0);
+	EXPECT_EQ(vec.get<1>(0), 1.5);
+
+	// the padding to the aligned start must be part of the block, not taken from the last column
+	const std::size_t used = region.used();
+	region.allocate(1, 1);
+
+	using small_vector = basic_soa_fixed_vector<arena_allocator<std::byte>, char, double>;
+	small_vector small(1, region);
+	small.emplace_back('a', 2.5);
+
+	const std::byte* column_end = reinterpret_cast<const std::byte*>(small.column<1>().data() + 1);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(small.column<1>().data()) % alignof(double), 0);
+	EXPECT_LE(column_end, buffer + region.used());
+	EXPECT_GT(region.used(), used + 1);
+}
+
+}
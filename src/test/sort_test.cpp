@@ -0,0 +1,127 @@
+﻿#include <fv/sort.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace sort_test
+{
+
+template<class T>
+std::vector<T> random_items(uint32_t count, uint32_t seed)
+{
+	std::mt19937_64 random(seed);
+	std::vector<T> items(count);
+
+	for (T& item : items)
+	{
+		if constexpr (std::is_floating_point_v<T>)
+			item = std::uniform_real_distribution<T>(-1e6, 1e6)(random);
+		else
+			item = static_cast<T>(random());
+	}
+
+	return items;
+}
+
+template<class T>
+class radix_sort_typed : public ::testing::Test {};
+
+using radix_types = ::testing::Types<uint8_t, int16_t, int32_t, uint64_t, int64_t, float, double>;
+TYPED_TEST_SUITE(radix_sort_typed, radix_types);
+
+TYPED_TEST(radix_sort_typed, matches_std_sort)
+{
+	for (uint32_t count : { 1u, 100u, 10000u })
+	{
+		const std::vector<TypeParam> items = random_items<TypeParam>(count, count);
+
+		fixed_vector<TypeParam> vec(count);
+		vec.insert_back(items);
+		radix_sort(vec);
+
+		std::vector<TypeParam> expected = items;
+		std::sort(expected.begin(), expected.end());
+
+		EXPECT_TRUE(std::equal(vec.begin(), vec.end(), expected.begin(), expected.end())) << "count " << count;
+	}
+}
+
+struct event
+{
+	int64_t time;
+	uint32_t id;
+};
+
+TEST(sort, by_key_is_stable)
+{
+	constexpr uint32_t COUNT = 20000;
+
+	fixed_vector<event> vec(COUNT);
+	for (uint32_t i = 0; i < COUNT; ++i)
+		vec.push_back({ int64_t(i % 97) - 50, i });
+
+	stable_sort(vec, [](const event& e) { return e.time; });
+
+	for (uint32_t i = 1; i < COUNT; ++i)
+	{
+		ASSERT_LE(vec[i-1].time, vec[i].time);
+		if (vec[i-1].time == vec[i].time)
+		{
+			ASSERT_LT(vec[i-1].id, vec[i].id);
+		}
+	}
+}
+
+TEST(sort, parallel_sample_sort)
+{
+	constexpr uint32_t COUNT = 100000;
+
+	const std::vector<uint64_t> items = random_items<uint64_t>(COUNT, 7);
+
+	fixed_vector<uint64_t> vec(COUNT);
+	vec.insert_back(items);
+	parallel_sort(vec, std::identity{}, 4);
+
+	std::vector<uint64_t> expected = items;
+	std::sort(expected.begin(), expected.end());
+
+	EXPECT_TRUE(std::equal(vec.begin(), vec.end(), expected.begin(), expected.end()));
+
+	fixed_vector<event> events(COUNT);
+	for (uint32_t i = 0; i < COUNT; ++i)
+		events.push_back({ int64_t(items[i] % 1000), i });
+
+	parallel_sort(events, [](const event& e) { return e.time; }, 3);
+
+	for (uint32_t i = 1; i < COUNT; ++i)
+	{
+		ASSERT_LE(events[i-1].time, events[i].time);
+		if (events[i-1].time == events[i].time)
+		{
+			ASSERT_LT(events[i-1].id, events[i].id);
+		}
+	}
+}
+
+TEST(sort, falls_back_to_comparison_sort)
+{
+	fixed_vector<std::string> vec(4);
+	for (const char* s : { "pear", "apple", "plum", "fig" })
+		vec.emplace_back(s);
+
+	sort(vec);
+	EXPECT_EQ(vec[0], "apple");
+	EXPECT_EQ(vec[3], "plum");
+
+	stable_sort(vec, [](const std::string& s) { return s.size(); });
+	EXPECT_EQ(vec[0], "fig");
+	EXPECT_EQ(vec[1], "pear");
+	EXPECT_EQ(vec[2], "plum");
+	EXPECT_EQ(vec[3], "apple");
+}
+
+}
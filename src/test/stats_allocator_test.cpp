@@ -0,0 +1,129 @@
+﻿#include <fv/stats_allocator.hpp>
+#include <fv/virtual_memory_allocator.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace stats_allocator_test
+{
+
+const container_stats_snapshot& find(const std::vector<container_stats_snapshot>& snapshot, const std::string& name)
+{
+	return *std::ranges::find(snapshot, name, &container_stats_snapshot::name);
+}
+
+TEST(stats_allocator, records_usage)
+{
+	using fvector_int = fixed_vector<int, stats_allocator<int>>;
+
+	{
+		fvector_int vec(8, stats_allocator<int>("stats_test.usage"));
+
+		for (int i = 0; i < 6; ++i)
+			vec.push_back(i);
+
+		vec.remove(0);
+		vec.erase(0, 2);
+		vec.push_back_n(5, 7);
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		vec.clean();
+
+		const container_stats& stats = vec.get_allocator().stats();
+		EXPECT_EQ(stats.allocations.load(), 1u);
+		EXPECT_EQ(stats.live_bytes.load(), 8 * sizeof(int));
+		EXPECT_EQ(stats.pushed.load(), 11u);
+		EXPECT_EQ(stats.removed.load(), 11u);
+		EXPECT_EQ(stats.cleans.load(), 1u);
+		EXPECT_EQ(stats.peak_size.load(), 8u);
+		EXPECT_EQ(stats.times_full.load(), 1u);
+		EXPECT_GE(stats.full_ns.load(), 2000000u);
+
+		// a copy counts into the same entry
+		fvector_int copy = vec;
+		copy.push_back(1);
+		EXPECT_EQ(stats.allocations.load(), 2u);
+		EXPECT_EQ(stats.peak_live_bytes.load(), 16 * sizeof(int));
+	}
+
+	const auto snapshot = stats_registry::instance().snapshot();
+	const container_stats_snapshot& s = find(snapshot, "stats_test.usage");
+
+	EXPECT_EQ(s.deallocations, 2u);
+	EXPECT_EQ(s.live_bytes, 0u);
+	EXPECT_EQ(s.max_capacity, 8u);
+	EXPECT_DOUBLE_EQ(s.peak_occupancy, 1.0);
+	EXPECT_EQ(s.pushed, 12u);
+}
+
+TEST(stats_allocator, emplace_back_and_moved_from)
+{
+	using fvector_int = fixed_vector<int, stats_allocator<int>>;
+
+	fvector_int vec(4, stats_allocator<int>("stats_test.emplace"));
+	for (int i = 0; i < 4; ++i)
+		vec.emplace_back(i);
+
+	const container_stats& stats = vec.get_allocator().stats();
+	EXPECT_EQ(stats.pushed.load(), 4u);
+	EXPECT_EQ(stats.peak_size.load(), 4u);
+	EXPECT_EQ(stats.times_full.load(), 1u);
+
+	// assigning between moved-from vectors reports an empty push with zero capacity
+	fvector_int a(std::move(vec));
+	fvector_int b(std::move(a));
+	a = std::move(vec);
+	EXPECT_EQ(stats.times_full.load(), 1u);
+	EXPECT_EQ(stats.peak_occupancy_ppm.load(), 1000000u);
+}
+
+TEST(stats_allocator, move_counts_full_time_once)
+{
+	using fvector_int = fixed_vector<int, stats_allocator<int>>;
+	using clock = std::chrono::steady_clock;
+
+	const clock::time_point start = clock::now();
+
+	fvector_int vec(2, stats_allocator<int>("stats_test.move_full"));
+	vec.push_back(1);
+	vec.push_back(2);
+
+	// the full period moves with the items, the moved-from source does not end it a second time
+	fvector_int moved(std::move(vec));
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	vec.clean();
+	moved.clean();
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+
+	const container_stats& stats = moved.get_allocator().stats();
+	EXPECT_EQ(stats.times_full.load(), 1u);
+	EXPECT_GE(stats.full_ns.load(), 2000000u);
+	EXPECT_LE(stats.full_ns.load(), uint64_t(elapsed.count()));
+}
+
+TEST(stats_allocator, wraps_other_allocators_and_dumps)
+{
+	using allocator = stats_allocator<int, virtual_memory_allocator<int, true>>;
+	static_assert(discarding_allocator_concept<allocator, int>);
+	static_assert(!discarding_allocator_concept<stats_allocator<int>, int>);
+
+	fixed_vector<int, allocator> vec(1024, allocator("stats_test.virtual"));
+	vec.resize_uninitialized(512);
+	vec.resize_uninitialized(256);
+	vec.clean();
+
+	std::ostringstream out;
+	stats_registry::instance().dump(out);
+
+	const std::string text = out.str();
+	EXPECT_NE(text.find("stats_test.virtual: allocations 1 (4096 bytes"), std::string::npos) << text;
+	EXPECT_NE(text.find("peak size 512 of 1024 (50%)"), std::string::npos) << text;
+	EXPECT_NE(text.find("pushed 512, removed 512, cleans 1"), std::string::npos) << text;
+}
+
+}
@@ -0,0 +1,86 @@
+﻿#include <fv/virtual_memory_allocator.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace virtual_memory_allocator_test
+{
+
+TEST(virtual_memory_allocator, huge_capacity)
+{
+	using fvector_int = fixed_vector<int, virtual_memory_allocator<int>>;
+
+	// 1 GiB of address space, only the touched pages are backed
+	fvector_int vec(1u << 28);
+
+	for (int i = 0; i < 1000; ++i)
+		vec.push_back(i);
+
+	EXPECT_EQ(vec.size(), 1000);
+	EXPECT_EQ(vec[999], 999);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(vec.begin()) % fv_detail::page_size(), 0);
+}
+
+TEST(virtual_memory_allocator, discard_on_clean)
+{
+	using fvector_int = fixed_vector<int, virtual_memory_allocator<int, true>>;
+
+	fvector_int vec(1 << 20);
+
+	for (int i = 0; i < 5000; ++i)
+		vec.push_back(i);
+
+	vec.clean();
+
+	EXPECT_TRUE(vec.empty());
+
+	// discarded pages are mapped again on demand
+	vec.push_back(42);
+	EXPECT_EQ(vec[0], 42);
+}
+
+#if defined(__linux__)
+
+std::size_t resident_bytes(const void* p, std::size_t bytes)
+{
+	const std::size_t page = fv_detail::page_size();
+	std::vector<unsigned char> pages((bytes + page - 1) / page);
+
+	if (mincore(const_cast<void*>(p), bytes, pages.data()) != 0)
+		return SIZE_MAX;
+
+	std::size_t resident = 0;
+	for (unsigned char flags : pages)
+		resident += (flags & 1) ? page : 0;
+
+	return resident;
+}
+
+TEST(virtual_memory_allocator, residency)
+{
+	using fvector_int = fixed_vector<int, virtual_memory_allocator<int, true>>;
+
+	fvector_int sparse(1u << 28);
+	for (int i = 0; i < 1000; ++i)
+		sparse.push_back(i);
+
+	// transparent huge pages may back the touched range with up to two huge pages
+	const std::size_t sparse_resident = resident_bytes(sparse.begin(), std::size_t(sparse.capacity()) * sizeof(int));
+	EXPECT_GE(sparse_resident, 1000 * sizeof(int));
+	EXPECT_LE(sparse_resident, 2 * fv_detail::huge_page_size);
+
+	fvector_int vec(1 << 20);
+	for (int i = 0; i < 1 << 19; ++i)
+		vec.push_back(i);
+
+	const std::size_t bytes = std::size_t(vec.capacity()) * sizeof(int);
+	EXPECT_GE(resident_bytes(vec.begin(), bytes), (1u << 19) * sizeof(int));
+
+	vec.clean();
+	EXPECT_EQ(resident_bytes(vec.begin(), bytes), 0u);
+}
+
+#endif
+
+}